@@ -0,0 +1,151 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/atomic"
+#include "../include/thread"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+// With native C++11 support stdex::atomic is std::atomic, so these runs
+// then measure the standard library itself.
+
+using namespace stdex;
+
+namespace
+{
+	template<memory_order _Order>
+	struct fetch_add
+	{
+		explicit fetch_add(atomic<long> &a) :
+			a(&a)
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(a->fetch_add(1, _Order));
+		}
+
+		atomic<long> *a;
+	};
+
+	// The increment written as a compare-exchange loop.
+	struct cas_increment
+	{
+		explicit cas_increment(atomic<long> &a) :
+			a(&a)
+		{}
+
+		void operator()()
+		{
+			long expected = a->load(memory_order_relaxed);
+
+			while (!a->compare_exchange_weak(expected, expected + 1))
+				;
+		}
+
+		atomic<long> *a;
+	};
+
+	struct load_acquire
+	{
+		explicit load_acquire(atomic<long> &a) :
+			a(&a)
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(a->load(memory_order_acquire));
+		}
+
+		atomic<long> *a;
+	};
+
+	struct store_release
+	{
+		explicit store_release(atomic<long> &a) :
+			a(&a),
+			n(0)
+		{}
+
+		void operator()()
+		{
+			a->store(++n, memory_order_release);
+		}
+
+		atomic<long> *a;
+		long n;
+	};
+
+	// A spin lock taken and released without contention.
+	struct flag_lock_unlock
+	{
+		explicit flag_lock_unlock(atomic_flag &f) :
+			f(&f)
+		{}
+
+		void operator()()
+		{
+			while (f->test_and_set(memory_order_acquire))
+				;
+			f->clear(memory_order_release);
+		}
+
+		atomic_flag *f;
+	};
+
+	// Plain increment of a non-atomic counter, for scale.
+	struct plain_increment
+	{
+		explicit plain_increment(long &n) :
+			n(&n)
+		{}
+
+		void operator()()
+		{
+			++*n;
+			bench::clobber_memory();
+		}
+
+		long *n;
+	};
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	atomic<long> counter(0);
+	atomic_flag flag;
+	long plain = 0;
+	unsigned threads = thread::hardware_concurrency();
+
+	if (threads < 2)
+		threads = 2;
+
+	flag.clear(); // std::atomic_flag starts out unspecified
+
+	r.run("increment (not atomic)", plain_increment(plain));
+	r.run("fetch_add relaxed", fetch_add<memory_order_relaxed>(counter));
+	r.run("fetch_add seq_cst", fetch_add<memory_order_seq_cst>(counter));
+	r.run("compare_exchange_weak increment", cas_increment(counter));
+	r.run("load acquire", load_acquire(counter));
+	r.run("store release", store_release(counter));
+	r.run("atomic_flag lock/unlock", flag_lock_unlock(flag));
+
+	// One counter for all threads: the cost of the contended cache line
+	r.run_parallel("fetch_add relaxed", threads, fetch_add<memory_order_relaxed>(counter));
+	r.run_parallel("compare_exchange_weak increment", threads, cas_increment(counter));
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
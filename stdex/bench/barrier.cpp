@@ -0,0 +1,133 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/barrier"
+#include "../include/mutex"
+#include "../include/condition_variable"
+#include "../include/thread"
+
+// POSIX includes
+#include <pthread.h>
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+// std::barrier is C++20, so there is no std:: run; pthread_barrier_t and a
+// generation count behind a mutex and a condition variable stand in for it.
+
+using namespace stdex;
+
+namespace
+{
+	// A barrier as written before barrier: the last thread of a generation
+	// starts the next one and wakes the others.
+	class locked_barrier
+	{
+	public:
+		explicit locked_barrier(unsigned expected) :
+			_expected(expected),
+			_arrived(0),
+			_generation(0)
+		{}
+
+		void arrive_and_wait()
+		{
+			unique_lock<mutex> lock(_lock);
+			const unsigned long generation = _generation;
+
+			if (++_arrived == _expected)
+			{
+				_arrived = 0;
+				++_generation;
+				_next.notify_all();
+				return;
+			}
+
+			while (generation == _generation)
+				_next.wait(lock);
+		}
+
+	private:
+		mutex _lock;
+		condition_variable _next;
+		unsigned _expected;
+		unsigned _arrived;
+		unsigned long _generation;
+	};
+
+	class posix_barrier
+	{
+	public:
+		explicit posix_barrier(unsigned expected)
+		{
+			pthread_barrier_init(&_barrier, 0, expected);
+		}
+
+		~posix_barrier()
+		{
+			pthread_barrier_destroy(&_barrier);
+		}
+
+		void arrive_and_wait()
+		{
+			pthread_barrier_wait(&_barrier);
+		}
+
+	private:
+		pthread_barrier_t _barrier;
+	};
+
+	// An iteration is one phase of all threads.
+	template<class _Barrier>
+	struct phase
+	{
+		explicit phase(_Barrier &b) :
+			b(&b)
+		{}
+
+		void operator()()
+		{
+			b->arrive_and_wait();
+		}
+
+		_Barrier *b;
+	};
+
+	template<class _Barrier>
+	void barrier_suite(bench::runner &r, const std::string &name, unsigned threads)
+	{
+		_Barrier b(threads);
+
+		r.run_parallel(name + " arrive_and_wait", threads, phase<_Barrier>(b));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	unsigned threads = thread::hardware_concurrency();
+
+	if (threads < 2)
+		threads = 2;
+
+	barrier_suite<barrier<> >(r, "barrier", 2);
+	barrier_suite<posix_barrier>(r, "pthread_barrier_t", 2);
+	barrier_suite<locked_barrier>(r, "mutex+condition_variable", 2);
+
+	if (threads > 2)
+	{
+		barrier_suite<barrier<> >(r, "barrier", threads);
+		barrier_suite<posix_barrier>(r, "pthread_barrier_t", threads);
+		barrier_suite<locked_barrier>(r, "mutex+condition_variable", threads);
+	}
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,350 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/basic_string_ex.h"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace stdex;
+
+namespace
+{
+	// Input that changes with every call, so nothing is folded away.
+	struct integer_to_string
+	{
+		integer_to_string() :
+			value(1234567)
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(stdex::to_string(value++));
+		}
+
+		int value;
+	};
+
+	struct double_to_string
+	{
+		double_to_string() :
+			value(3.14159)
+		{}
+
+		void operator()()
+		{
+			value += 0.001;
+			bench::do_not_optimize(stdex::to_string(value));
+		}
+
+		double value;
+	};
+
+	// The formatters to_chars replaces, into the same stack buffer.
+	struct integer_to_chars
+	{
+		integer_to_chars() :
+			value(1234567)
+		{}
+
+		void operator()()
+		{
+			char buf[32];
+			to_chars_result res = to_chars(buf, buf + sizeof(buf), value++);
+
+			bench::do_not_optimize(res.ptr);
+			bench::do_not_optimize(buf);
+		}
+
+		int value;
+	};
+
+	struct double_to_chars
+	{
+		double_to_chars() :
+			value(3.14159)
+		{}
+
+		void operator()()
+		{
+			char buf[32];
+
+			value += 0.001;
+
+			to_chars_result res = to_chars(buf, buf + sizeof(buf), value);
+
+			bench::do_not_optimize(res.ptr);
+			bench::do_not_optimize(buf);
+		}
+
+		double value;
+	};
+
+	struct integer_sprintf
+	{
+		integer_sprintf() :
+			value(1234567)
+		{}
+
+		void operator()()
+		{
+			char buf[32];
+
+			bench::do_not_optimize(std::sprintf(buf, "%d", value++));
+			bench::do_not_optimize(buf);
+		}
+
+		int value;
+	};
+
+	// %.17g round-trips like to_chars, but does not look for the shortest form.
+	struct double_sprintf
+	{
+		double_sprintf() :
+			value(3.14159)
+		{}
+
+		void operator()()
+		{
+			char buf[32];
+
+			value += 0.001;
+
+			bench::do_not_optimize(std::sprintf(buf, "%.17g", value));
+			bench::do_not_optimize(buf);
+		}
+
+		double value;
+	};
+
+	struct integer_stringstream
+	{
+		integer_stringstream() :
+			value(1234567)
+		{}
+
+		void operator()()
+		{
+			std::ostringstream out;
+
+			out << value++;
+			bench::do_not_optimize(out.str());
+		}
+
+		int value;
+	};
+
+	struct double_stringstream
+	{
+		double_stringstream() :
+			value(3.14159)
+		{}
+
+		void operator()()
+		{
+			std::ostringstream out;
+
+			value += 0.001;
+
+			out << std::setprecision(17) << value;
+			bench::do_not_optimize(out.str());
+		}
+
+		double value;
+	};
+
+	struct string_to_int
+	{
+		string_to_int() :
+			text("-1234567")
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(stot<int>(text));
+		}
+
+		std::string text;
+	};
+
+	struct string_to_double
+	{
+		string_to_double() :
+			text("-1234.56789e-3")
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(stot<double>(text));
+		}
+
+		std::string text;
+	};
+
+	// The parsers stot and from_chars replace, on the same text.
+	struct int_from_chars
+	{
+		int_from_chars() :
+			text("-1234567")
+		{}
+
+		void operator()()
+		{
+			int value;
+
+			from_chars(text, text + 8, value);
+			bench::do_not_optimize(value);
+		}
+
+		const char *text;
+	};
+
+	struct double_from_chars
+	{
+		double_from_chars() :
+			text("-1234.56789e-3")
+		{}
+
+		void operator()()
+		{
+			double value;
+
+			from_chars(text, text + 14, value);
+			bench::do_not_optimize(value);
+		}
+
+		const char *text;
+	};
+
+	struct int_strtol
+	{
+		int_strtol() :
+			text("-1234567")
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(std::strtol(text, 0, 10));
+		}
+
+		const char *text;
+	};
+
+	struct double_strtod
+	{
+		double_strtod() :
+			text("-1234.56789e-3")
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(std::strtod(text, 0));
+		}
+
+		const char *text;
+	};
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	struct std_integer_to_string
+	{
+		std_integer_to_string() :
+			value(1234567)
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(std::to_string(value++));
+		}
+
+		int value;
+	};
+
+	struct std_double_to_string
+	{
+		std_double_to_string() :
+			value(3.14159)
+		{}
+
+		void operator()()
+		{
+			value += 0.001;
+			bench::do_not_optimize(std::to_string(value));
+		}
+
+		double value;
+	};
+
+	struct std_string_to_int
+	{
+		std_string_to_int() :
+			text("-1234567")
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(std::stoi(text));
+		}
+
+		std::string text;
+	};
+
+	struct std_string_to_double
+	{
+		std_string_to_double() :
+			text("-1234.56789e-3")
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(std::stod(text));
+		}
+
+		std::string text;
+	};
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	r.run("to_string(int)", integer_to_string());
+	r.run("to_string(double)", double_to_string());
+	r.run("to_chars(int)", integer_to_chars());
+	r.run("to_chars(double)", double_to_chars());
+	r.run("sprintf(\"%d\")", integer_sprintf());
+	r.run("sprintf(\"%.17g\")", double_sprintf());
+	r.run("ostringstream << int", integer_stringstream());
+	r.run("ostringstream << double", double_stringstream());
+	r.run("stot<int>", string_to_int());
+	r.run("stot<double>", string_to_double());
+	r.run("from_chars(int)", int_from_chars());
+	r.run("from_chars(double)", double_from_chars());
+	r.run("strtol", int_strtol());
+	r.run("strtod", double_strtod());
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	r.run("std::to_string(int)", std_integer_to_string());
+	r.run("std::to_string(double)", std_double_to_string());
+	r.run("std::stoi", std_string_to_int());
+	r.run("std::stod", std_string_to_double());
+#endif
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/chrono"
+
+// POSIX includes
+#include <time.h>
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+#include <chrono>
+#endif
+
+using namespace stdex;
+
+namespace
+{
+	// Reads a clock; works for the std:: clocks as well.
+	template<class _Clock>
+	struct clock_now
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(_Clock::now());
+		}
+	};
+
+	// The system call (or vDSO function) under the clocks.
+	template<clockid_t _Clock>
+	struct posix_clock_gettime
+	{
+		void operator()()
+		{
+			timespec ts;
+
+			clock_gettime(_Clock, &ts);
+			bench::do_not_optimize(ts);
+		}
+	};
+
+	struct duration_arithmetic
+	{
+		duration_arithmetic() :
+			d(12345)
+		{}
+
+		void operator()()
+		{
+			chrono::nanoseconds ns = chrono::duration_cast<chrono::nanoseconds>(d) + chrono::milliseconds(1);
+			bench::do_not_optimize(chrono::duration_cast<chrono::milliseconds>(ns).count());
+		}
+
+		chrono::microseconds d;
+	};
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	// The first call of fast_steady_clock calibrates the TSC for 10 ms; keep
+	// it out of the calibration of the iteration count
+	chrono::fast_steady_clock::now();
+
+	r.run("system_clock::now", clock_now<chrono::system_clock>());
+	r.run("steady_clock::now", clock_now<chrono::steady_clock>());
+	r.run("fast_steady_clock::now", clock_now<chrono::fast_steady_clock>());
+	r.run("high_resolution_clock::now", clock_now<chrono::high_resolution_clock>());
+	r.run("clock_gettime(CLOCK_REALTIME)", posix_clock_gettime<CLOCK_REALTIME>());
+	r.run("clock_gettime(CLOCK_MONOTONIC)", posix_clock_gettime<CLOCK_MONOTONIC>());
+	r.run("duration_cast", duration_arithmetic());
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	r.run("std::chrono::system_clock::now", clock_now<std::chrono::system_clock>());
+	r.run("std::chrono::steady_clock::now", clock_now<std::chrono::steady_clock>());
+	r.run("std::chrono::high_resolution_clock::now", clock_now<std::chrono::high_resolution_clock>());
+#endif
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
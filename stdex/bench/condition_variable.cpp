@@ -0,0 +1,111 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/condition_variable"
+#include "../include/mutex"
+#include "../include/atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+#include <condition_variable>
+#include <mutex>
+#endif
+
+using namespace stdex;
+
+namespace
+{
+	template<class _Cond>
+	struct notify_no_waiter
+	{
+		explicit notify_no_waiter(_Cond &c) :
+			c(&c)
+		{}
+
+		void operator()()
+		{
+			c->notify_one();
+		}
+
+		_Cond *c;
+	};
+
+	// Two threads hand a turn back and forth; an iteration is one hand-off
+	// per thread, so the time is a wake-up round trip.
+	template<class _Mutex, class _Cond, class _Lock>
+	struct ping_pong
+	{
+		struct shared
+		{
+			_Mutex m;
+			_Cond c;
+			int turn;
+			atomic<unsigned> tickets;
+		};
+
+		explicit ping_pong(shared &s) :
+			s(&s),
+			role(-1)
+		{}
+
+		void operator()()
+		{
+			if (role < 0)
+				role = static_cast<int>(s->tickets.fetch_add(1) % 2);
+
+			_Lock lock(s->m);
+
+			while (s->turn != role)
+				s->c.wait(lock);
+
+			s->turn = 1 - role;
+			s->c.notify_one();
+		}
+
+		shared *s;
+		int role;
+	};
+
+	template<class _Mutex, class _Cond, class _Lock>
+	void cv_suite(bench::runner &r, const std::string &name)
+	{
+		typedef ping_pong<_Mutex, _Cond, _Lock> _ping_pong;
+
+		_Cond c;
+		typename _ping_pong::shared s;
+
+		s.turn = 0;
+		s.tickets.store(0);
+
+		r.run(name + " notify_one, no waiter", notify_no_waiter<_Cond>(c));
+		r.run_parallel(name + " ping-pong", 2, _ping_pong(s));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	cv_suite<mutex, condition_variable, unique_lock<mutex> >(r, "condition_variable");
+	cv_suite<mutex, condition_variable_any, unique_lock<mutex> >(r, "condition_variable_any");
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	cv_suite<std::mutex, std::condition_variable, std::unique_lock<std::mutex> >(r, "std::condition_variable");
+	cv_suite<std::mutex, std::condition_variable_any, std::unique_lock<std::mutex> >(r, "std::condition_variable_any");
+#endif
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
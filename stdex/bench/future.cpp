@@ -0,0 +1,135 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/future"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+#include <future>
+#endif
+
+using namespace stdex;
+
+namespace
+{
+	int answer()
+	{
+		return 42;
+	}
+
+	// A result handed over on the same thread: the cost of the shared state.
+	struct promise_get
+	{
+		void operator()()
+		{
+			promise<int> p;
+			future<int> f = p.get_future();
+
+			p.set_value(42);
+			bench::do_not_optimize(f.get());
+		}
+	};
+
+	struct packaged_task_get
+	{
+		void operator()()
+		{
+			packaged_task<int()> task(&answer);
+			future<int> f = task.get_future();
+
+			task();
+			bench::do_not_optimize(f.get());
+		}
+	};
+
+	// A thread per call, started by async and joined through get.
+	struct async_get
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(stdex::async(launch::async, &answer).get());
+		}
+	};
+
+	struct deferred_get
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(stdex::async(launch::deferred, &answer).get());
+		}
+	};
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	struct std_promise_get
+	{
+		void operator()()
+		{
+			std::promise<int> p;
+			std::future<int> f = p.get_future();
+
+			p.set_value(42);
+			bench::do_not_optimize(f.get());
+		}
+	};
+
+	struct std_packaged_task_get
+	{
+		void operator()()
+		{
+			std::packaged_task<int()> task(&answer);
+			std::future<int> f = task.get_future();
+
+			task();
+			bench::do_not_optimize(f.get());
+		}
+	};
+
+	struct std_async_get
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(std::async(std::launch::async, &answer).get());
+		}
+	};
+
+	struct std_deferred_get
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(std::async(std::launch::deferred, &answer).get());
+		}
+	};
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	r.run("promise set_value/get", promise_get());
+	r.run("packaged_task call/get", packaged_task_get());
+	r.run("async(launch::async)/get", async_get());
+	r.run("async(launch::deferred)/get", deferred_get());
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	r.run("std::promise set_value/get", std_promise_get());
+	r.run("std::packaged_task call/get", std_packaged_task_get());
+	r.run("std::async(launch::async)/get", std_async_get());
+	r.run("std::async(launch::deferred)/get", std_deferred_get());
+#endif
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
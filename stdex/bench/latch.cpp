@@ -0,0 +1,84 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/latch"
+#include "../include/thread"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+// std::latch is C++20, so there is no std:: run.
+
+using namespace stdex;
+
+namespace
+{
+	// A latch made, opened and waited for on one thread.
+	struct count_down_wait
+	{
+		void operator()()
+		{
+			latch l(1);
+
+			l.count_down();
+			l.wait();
+		}
+	};
+
+	// Checking an open latch, the path of every thread that comes late.
+	struct open_try_wait
+	{
+		explicit open_try_wait(const latch &l) :
+			l(&l)
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(l->try_wait());
+		}
+
+		const latch *l;
+	};
+
+	struct open_wait
+	{
+		explicit open_wait(latch &l) :
+			l(&l)
+		{}
+
+		void operator()()
+		{
+			l->wait();
+		}
+
+		latch *l;
+	};
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	latch open(0);
+	unsigned threads = thread::hardware_concurrency();
+
+	if (threads < 2)
+		threads = 2;
+
+	r.run("latch count_down/wait", count_down_wait());
+	r.run("open latch try_wait", open_try_wait(open));
+	r.run("open latch wait", open_wait(open));
+	r.run_parallel("open latch wait", threads, open_wait(open));
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
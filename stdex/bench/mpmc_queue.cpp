@@ -0,0 +1,152 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/mpmc_queue"
+#include "../include/mutex"
+#include "../include/condition_variable"
+#include "../include/thread"
+#include "../include/atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace stdex;
+
+namespace
+{
+	const std::size_t capacity = 1024;
+
+	// What mpmc_queue replaces: a deque guarded by a mutex and two
+	// condition variables.
+	class locked_queue
+	{
+	public:
+		explicit locked_queue(std::size_t capacity) :
+			_capacity(capacity)
+		{}
+
+		void push(unsigned long value)
+		{
+			unique_lock<mutex> lock(_lock);
+
+			while (_items.size() == _capacity)
+				_not_full.wait(lock);
+
+			_items.push_back(value);
+			_not_empty.notify_one();
+		}
+
+		void pop(unsigned long &value)
+		{
+			unique_lock<mutex> lock(_lock);
+
+			while (_items.empty())
+				_not_empty.wait(lock);
+
+			value = _items.front();
+			_items.pop_front();
+			_not_full.notify_one();
+		}
+
+	private:
+		std::size_t _capacity;
+		mutex _lock;
+		condition_variable _not_empty;
+		condition_variable _not_full;
+		std::deque<unsigned long> _items;
+	};
+
+	// The first producers threads to call push, the others pop; an
+	// iteration is one message per thread.
+	template<class _Queue>
+	struct handoff
+	{
+		struct shared
+		{
+			_Queue queue;
+			unsigned producers;
+			atomic<unsigned> tickets;
+
+			explicit shared(unsigned producers_) :
+				queue(capacity),
+				producers(producers_),
+				tickets(0)
+			{}
+		};
+
+		explicit handoff(shared &s) :
+			s(&s),
+			role(-1),
+			value(0)
+		{}
+
+		void operator()()
+		{
+			if (role < 0)
+				role = static_cast<int>(s->tickets.fetch_add(1) % (2 * s->producers));
+
+			if (static_cast<unsigned>(role) < s->producers)
+				s->queue.push(++value);
+			else
+				s->queue.pop(value);
+		}
+
+		shared *s;
+		int role;
+		unsigned long value;
+	};
+
+	template<class _Queue>
+	void handoff_suite(bench::runner &r, const char *name, unsigned producers)
+	{
+		typename handoff<_Queue>::shared s(producers);
+		std::ostringstream label;
+
+		label << name << ' ' << producers << "P" << producers << "C";
+
+		r.run_parallel(label.str(), 2 * producers, handoff<_Queue>(s));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	unsigned n = thread::hardware_concurrency() / 2;
+
+	if (!n)
+		n = 1;
+
+	const unsigned producers[] = { 1, 4, n };
+	const unsigned configs = (n == 1 || n == 4) ? 2 : 3;
+
+	for (unsigned i = 0; i < configs; ++i)
+	{
+		handoff_suite<mpmc_queue<unsigned long> >(r, "mpmc_queue", producers[i]);
+		handoff_suite<locked_queue>(r, "mutex+condition_variable deque", producers[i]);
+	}
+
+	r.write_text(std::cout);
+
+	std::cout << '\n';
+
+	for (std::size_t i = 0; i < r.results().size(); ++i)
+	{
+		const bench::result &res = r.results()[i];
+
+		// every producer sends one message per iteration
+		std::cout << res.name << ": " << static_cast<unsigned long>(res.threads / 2 * 1e9 / res.p50) << " msgs/s\n";
+	}
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,217 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/mutex"
+#include "../include/thread"
+
+// POSIX includes
+#include <pthread.h>
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+#include <mutex>
+#endif
+
+using namespace stdex;
+
+namespace
+{
+	// Takes and releases a mutex shared by all copies.
+	template<class _Mutex>
+	struct lock_unlock
+	{
+		explicit lock_unlock(_Mutex &m) :
+			m(&m)
+		{}
+
+		void operator()()
+		{
+			m->lock();
+			m->unlock();
+		}
+
+		_Mutex *m;
+	};
+
+	template<class _Mutex>
+	struct scoped_lock
+	{
+		explicit scoped_lock(_Mutex &m) :
+			m(&m)
+		{}
+
+		void operator()()
+		{
+			lock_guard<_Mutex> lock(*m);
+		}
+
+		_Mutex *m;
+	};
+
+	template<class _Mutex>
+	struct try_lock_unlock
+	{
+		explicit try_lock_unlock(_Mutex &m) :
+			m(&m)
+		{}
+
+		void operator()()
+		{
+			if (m->try_lock())
+				m->unlock();
+		}
+
+		_Mutex *m;
+	};
+
+	// The very short critical section adaptive_mutex is made for.
+	template<class _Mutex>
+	struct locked_increment
+	{
+		struct shared
+		{
+			_Mutex m;
+			unsigned long counter;
+		};
+
+		explicit locked_increment(shared &s) :
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			lock_guard<_Mutex> lock(s->m);
+			++s->counter;
+		}
+
+		shared *s;
+	};
+
+	void init_once()
+	{}
+
+	// call_once after the first call: the path every later caller takes.
+	struct call_once_done
+	{
+		explicit call_once_done(once_flag &flag) :
+			flag(&flag)
+		{}
+
+		void operator()()
+		{
+			call_once(*flag, &init_once);
+		}
+
+		once_flag *flag;
+	};
+
+	struct pthread_once_done
+	{
+		explicit pthread_once_done(pthread_once_t &once) :
+			once(&once)
+		{}
+
+		void operator()()
+		{
+			pthread_once(once, &init_once);
+		}
+
+		pthread_once_t *once;
+	};
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	struct std_call_once_done
+	{
+		explicit std_call_once_done(std::once_flag &flag) :
+			flag(&flag)
+		{}
+
+		void operator()()
+		{
+			std::call_once(*flag, &init_once);
+		}
+
+		std::once_flag *flag;
+	};
+#endif
+
+	template<class _Mutex>
+	void lock_suite(bench::runner &r, const std::string &name, _Mutex &m)
+	{
+		const unsigned threads = thread::hardware_concurrency();
+
+		r.run(name + " lock/unlock", lock_unlock<_Mutex>(m));
+		r.run(name + " lock_guard", scoped_lock<_Mutex>(m));
+		r.run(name + " try_lock/unlock", try_lock_unlock<_Mutex>(m));
+		r.run_parallel(name + " lock/unlock", threads > 2 ? threads : 2, lock_unlock<_Mutex>(m));
+	}
+
+	// Uncontended, 2 threads and all hardware threads.
+	template<class _Mutex>
+	void contention_suite(bench::runner &r, const std::string &name)
+	{
+		typedef locked_increment<_Mutex> _increment;
+
+		const unsigned threads = thread::hardware_concurrency();
+		typename _increment::shared s;
+
+		s.counter = 0;
+
+		r.run(name + " increment", _increment(s));
+		r.run_parallel(name + " increment", 2, _increment(s));
+
+		if (threads > 2)
+			r.run_parallel(name + " increment", threads, _increment(s));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	mutex m;
+	recursive_mutex rm;
+	timed_mutex tm;
+
+	lock_suite(r, "mutex", m);
+	lock_suite(r, "recursive_mutex", rm);
+	lock_suite(r, "timed_mutex", tm);
+
+	// adaptive_mutex against the pthread default behind mutex
+	contention_suite<mutex>(r, "mutex");
+	contention_suite<adaptive_mutex>(r, "adaptive_mutex");
+
+	once_flag once;
+	pthread_once_t posix_once = PTHREAD_ONCE_INIT;
+	const unsigned threads = thread::hardware_concurrency();
+
+	r.run("call_once, done", call_once_done(once));
+	r.run_parallel("call_once, done", threads > 2 ? threads : 2, call_once_done(once));
+	r.run("pthread_once, done", pthread_once_done(posix_once));
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	std::mutex std_m;
+	std::recursive_mutex std_rm;
+	std::timed_mutex std_tm;
+
+	lock_suite(r, "std::mutex", std_m);
+	lock_suite(r, "std::recursive_mutex", std_rm);
+	lock_suite(r, "std::timed_mutex", std_tm);
+
+	std::once_flag std_once;
+
+	r.run("std::call_once, done", std_call_once_done(std_once));
+#endif
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+// Recording is compiled into profiled_mutex only with this defined; without
+// it profiled_mutex<_Tag, mutex> is a mutex, so the plain mutex runs below
+// are what a disabled build costs.
+#define _STDEX_PROFILE_MUTEX
+
+// stdex includes
+#include "../include/bench"
+#include "../include/profiled_mutex"
+#include "../include/mutex"
+#include "../include/thread"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace stdex;
+
+namespace
+{
+	struct bench_lock
+	{
+		static const char* name()
+		{
+			return "bench";
+		}
+	};
+
+	typedef profiled_mutex<bench_lock> bench_mutex;
+
+	// Takes and releases a mutex shared by all copies.
+	template<class _Mutex>
+	struct lock_unlock
+	{
+		explicit lock_unlock(_Mutex &m) :
+			m(&m)
+		{}
+
+		void operator()()
+		{
+			lock_guard<_Mutex> lock(*m);
+		}
+
+		_Mutex *m;
+	};
+
+	template<class _Mutex>
+	struct locked_increment
+	{
+		struct shared
+		{
+			_Mutex m;
+			unsigned long counter;
+
+			shared() :
+				counter(0)
+			{}
+		};
+
+		explicit locked_increment(shared &s) :
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			lock_guard<_Mutex> lock(s->m);
+			++s->counter;
+		}
+
+		shared *s;
+	};
+
+	template<class _Mutex>
+	void contention_suite(bench::runner &r, const char *name, unsigned threads)
+	{
+		typename locked_increment<_Mutex>::shared s;
+
+		r.run_parallel(name, threads, locked_increment<_Mutex>(s));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	mutex plain;
+	bench_mutex profiled;
+	unsigned threads = thread::hardware_concurrency();
+
+	if (threads < 2)
+		threads = 2;
+
+	r.run("mutex lock/unlock", lock_unlock<mutex>(plain));
+	r.run("profiled_mutex lock/unlock", lock_unlock<bench_mutex>(profiled));
+
+	contention_suite<mutex>(r, "mutex, 2 threads", 2);
+	contention_suite<bench_mutex>(r, "profiled_mutex, 2 threads", 2);
+	contention_suite<mutex>(r, "mutex, N threads", threads);
+	contention_suite<bench_mutex>(r, "profiled_mutex, N threads", threads);
+
+	r.write_text(std::cout);
+
+	// Only the site total: every parallel run starts new threads, each with
+	// its own line in write_mutex_profile.
+	std::vector<mutex_site_stats> sites = mutex_profile_snapshot();
+
+	for (std::size_t i = 0; i < sites.size(); ++i)
+	{
+		const mutex_stats &total = sites[i].total;
+
+		std::cout << '\n' << sites[i].site << ": " << total.acquisitions << " locks, "
+			<< total.contended << " contended, recorded by " << sites[i].threads.size() << " threads\n";
+	}
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
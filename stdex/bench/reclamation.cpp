@@ -0,0 +1,156 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/reclamation"
+#include "../include/mutex"
+#include "../include/shared_mutex"
+#include "../include/thread"
+#include "../include/atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+using namespace stdex;
+
+namespace
+{
+	struct node
+	{
+		int value;
+	};
+
+	// Read-side cost only: a node read under each kind of protection, with
+	// no writer retiring anything.
+	struct shared
+	{
+		node n;
+		atomic<node*> current;
+		mutex m;
+		shared_mutex sm;
+		epoch_domain ebr;
+		hazard_domain hp;
+
+		shared() :
+			current(&n)
+		{
+			n.value = 1;
+		}
+	};
+
+	struct mutex_read
+	{
+		explicit mutex_read(shared &s) :
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			lock_guard<mutex> lock(s->m);
+			bench::do_not_optimize(s->n.value);
+		}
+
+		shared *s;
+	};
+
+	struct shared_mutex_read
+	{
+		explicit shared_mutex_read(shared &s) :
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			shared_lock<shared_mutex> lock(s->sm);
+			bench::do_not_optimize(s->n.value);
+		}
+
+		shared *s;
+	};
+
+	struct epoch_read
+	{
+		explicit epoch_read(shared &s) :
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			epoch_domain::guard g(s->ebr);
+			bench::do_not_optimize(s->current.load(memory_order_acquire)->value);
+		}
+
+		shared *s;
+	};
+
+	// protect() with a hazard pointer held across reads.
+	struct hazard_protect
+	{
+		hazard_protect(hazard_domain::hazard_pointer &h, shared &s) :
+			h(&h),
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(h->protect(s->current)->value);
+		}
+
+		hazard_domain::hazard_pointer *h;
+		shared *s;
+	};
+
+	// A hazard pointer taken and given back around every read.
+	struct hazard_read
+	{
+		explicit hazard_read(shared &s) :
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			hazard_domain::hazard_pointer h(s->hp);
+			bench::do_not_optimize(h.protect(s->current)->value);
+		}
+
+		shared *s;
+	};
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	shared s;
+	unsigned threads = thread::hardware_concurrency();
+
+	if (threads < 2)
+		threads = 2;
+
+	{
+		hazard_domain::hazard_pointer h(s.hp);
+
+		r.run("hazard_pointer::protect", hazard_protect(h, s));
+	}
+
+	r.run("hazard_pointer + protect", hazard_read(s));
+	r.run("epoch_domain::guard", epoch_read(s));
+	r.run("mutex lock/unlock", mutex_read(s));
+	r.run("shared_mutex lock_shared/unlock_shared", shared_mutex_read(s));
+
+	r.run_parallel("hazard_pointer + protect", threads, hazard_read(s));
+	r.run_parallel("epoch_domain::guard", threads, epoch_read(s));
+	r.run_parallel("mutex lock/unlock", threads, mutex_read(s));
+	r.run_parallel("shared_mutex lock_shared/unlock_shared", threads, shared_mutex_read(s));
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
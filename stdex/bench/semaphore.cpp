@@ -0,0 +1,165 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/semaphore"
+#include "../include/mutex"
+#include "../include/condition_variable"
+#include "../include/atomic"
+
+// POSIX includes
+#include <semaphore.h>
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+// std::counting_semaphore is C++20, so there is no std:: run; sem_t and a
+// counter behind a mutex and a condition variable stand in for it.
+
+using namespace stdex;
+
+namespace
+{
+	// A counter behind a mutex and a condition variable, as written before
+	// counting_semaphore.
+	class locked_semaphore
+	{
+	public:
+		explicit locked_semaphore(long desired) :
+			_count(desired)
+		{}
+
+		void release()
+		{
+			lock_guard<mutex> lock(_lock);
+
+			++_count;
+			_available.notify_one();
+		}
+
+		void acquire()
+		{
+			unique_lock<mutex> lock(_lock);
+
+			while (!_count)
+				_available.wait(lock);
+
+			--_count;
+		}
+
+	private:
+		mutex _lock;
+		condition_variable _available;
+		long _count;
+	};
+
+	class posix_semaphore
+	{
+	public:
+		explicit posix_semaphore(unsigned desired)
+		{
+			sem_init(&_sem, 0, desired);
+		}
+
+		~posix_semaphore()
+		{
+			sem_destroy(&_sem);
+		}
+
+		void release()
+		{
+			sem_post(&_sem);
+		}
+
+		void acquire()
+		{
+			while (sem_wait(&_sem) != 0)
+				;
+		}
+
+	private:
+		sem_t _sem;
+	};
+
+	template<class _Semaphore>
+	struct release_acquire
+	{
+		explicit release_acquire(_Semaphore &s) :
+			s(&s)
+		{}
+
+		void operator()()
+		{
+			s->release();
+			s->acquire();
+		}
+
+		_Semaphore *s;
+	};
+
+	// Two threads hand a turn back and forth through two semaphores; an
+	// iteration is one hand-off per thread.
+	template<class _Semaphore>
+	struct ping_pong
+	{
+		struct shared
+		{
+			_Semaphore first;   // the turn of role 0, available at the start
+			_Semaphore second;  // the turn of role 1
+			atomic<unsigned> tickets;
+
+			shared() :
+				first(1),
+				second(0),
+				tickets(0)
+			{}
+		};
+
+		explicit ping_pong(shared &s) :
+			s(&s),
+			role(-1)
+		{}
+
+		void operator()()
+		{
+			if (role < 0)
+				role = static_cast<int>(s->tickets.fetch_add(1) % 2);
+
+			(role ? s->second : s->first).acquire();
+			(role ? s->first : s->second).release();
+		}
+
+		shared *s;
+		int role;
+	};
+
+	template<class _Semaphore>
+	void semaphore_suite(bench::runner &r, const std::string &name)
+	{
+		_Semaphore s(0);
+
+		r.run(name + " release/acquire", release_acquire<_Semaphore>(s));
+
+		typename ping_pong<_Semaphore>::shared pp;
+
+		r.run_parallel(name + " ping-pong", 2, ping_pong<_Semaphore>(pp));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	semaphore_suite<counting_semaphore<> >(r, "counting_semaphore");
+	semaphore_suite<posix_semaphore>(r, "sem_t");
+	semaphore_suite<locked_semaphore>(r, "mutex+condition_variable");
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,158 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/shared_mutex"
+#include "../include/mutex"
+#include "../include/thread"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace stdex;
+
+namespace
+{
+	// Read-mostly table: one write every writes_every operations, the rest
+	// read all of it.
+	template<class _Mutex>
+	struct table
+	{
+		_Mutex m;
+		unsigned long values[16];
+
+		table()
+		{
+			_fill();
+		}
+
+		explicit table(shared_mutex_preference pref) :
+			m(pref)
+		{
+			_fill();
+		}
+
+		unsigned long read()
+		{
+			unsigned long sum = 0;
+
+			for (unsigned i = 0; i < 16; ++i)
+				sum += values[i];
+
+			return sum;
+		}
+
+		void write(unsigned n)
+		{
+			++values[n % 16];
+		}
+
+	private:
+		void _fill()
+		{
+			for (unsigned i = 0; i < 16; ++i)
+				values[i] = i;
+		}
+	};
+
+	template<class _Mutex>
+	struct shared_access
+	{
+		shared_access(table<_Mutex> &t, unsigned writes_every) :
+			t(&t),
+			writes_every(writes_every),
+			n(0)
+		{}
+
+		void operator()()
+		{
+			if (++n % writes_every == 0)
+			{
+				lock_guard<_Mutex> lock(t->m);
+				t->write(n);
+			}
+			else
+			{
+				shared_lock<_Mutex> lock(t->m);
+				bench::do_not_optimize(t->read());
+			}
+		}
+
+		table<_Mutex> *t;
+		unsigned writes_every;
+		unsigned n;
+	};
+
+	// The same mix with every operation exclusive.
+	struct exclusive_access
+	{
+		exclusive_access(table<mutex> &t, unsigned writes_every) :
+			t(&t),
+			writes_every(writes_every),
+			n(0)
+		{}
+
+		void operator()()
+		{
+			lock_guard<mutex> lock(t->m);
+
+			if (++n % writes_every == 0)
+				t->write(n);
+			else
+				bench::do_not_optimize(t->read());
+		}
+
+		table<mutex> *t;
+		unsigned writes_every;
+		unsigned n;
+	};
+
+	std::string mix_name(const char *name, unsigned writes_every)
+	{
+		std::ostringstream out;
+
+		out << name << ' ' << (100 - 100 / writes_every) << '/' << (100 / writes_every);
+		return out.str();
+	}
+
+	void mix_suite(bench::runner &r, unsigned threads, unsigned writes_every)
+	{
+		table<shared_mutex> readers_first(prefer_readers);
+		table<shared_mutex> writers_first(prefer_writers);
+		table<mutex> exclusive;
+
+		r.run_parallel(mix_name("shared_mutex", writes_every), threads,
+			shared_access<shared_mutex>(readers_first, writes_every));
+		r.run_parallel(mix_name("shared_mutex prefer_writers", writes_every), threads,
+			shared_access<shared_mutex>(writers_first, writes_every));
+		r.run_parallel(mix_name("mutex", writes_every), threads,
+			exclusive_access(exclusive, writes_every));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	const unsigned threads = thread::hardware_concurrency();
+
+	const unsigned writes_every[] = { 20, 100 }; // 95/5 and 99/1 read/write
+
+	for (unsigned i = 0; i < 2; ++i)
+	{
+		mix_suite(r, 1, writes_every[i]);
+		mix_suite(r, threads > 2 ? threads : 2, writes_every[i]);
+	}
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,170 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/thread"
+#include "../include/chrono"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace stdex;
+
+namespace
+{
+	// Upper bounds of the overshoot buckets, in microseconds; the last
+	// bucket takes everything above.
+	const long bucket_us[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000 };
+	const unsigned buckets = sizeof(bucket_us) / sizeof(bucket_us[0]) + 1;
+
+	struct histogram
+	{
+		std::string name;
+		std::vector<chrono::nanoseconds::rep> overshoot_ns;
+	};
+
+	enum sleep_mode
+	{
+		mode_sleep_for,
+		mode_sleep_until,
+		mode_precise_sleep_for
+	};
+
+	// One sleep per iteration; records how late it returned.
+	struct timed_sleep
+	{
+		timed_sleep(sleep_mode mode, chrono::microseconds target, histogram &h) :
+			mode(mode),
+			target(target),
+			h(&h)
+		{}
+
+		void operator()()
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+			switch (mode)
+			{
+			case mode_sleep_for:
+				this_thread::sleep_for(target);
+				break;
+			case mode_sleep_until:
+				this_thread::sleep_until(start + target);
+				break;
+			case mode_precise_sleep_for:
+				this_thread::precise_sleep_for(target);
+				break;
+			}
+
+			h->overshoot_ns.push_back(
+				chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start - target).count());
+		}
+
+		sleep_mode mode;
+		chrono::microseconds target;
+		histogram *h;
+	};
+
+	std::string sleep_name(const char *name, chrono::microseconds target)
+	{
+		std::ostringstream out;
+
+		if (target.count() >= 1000)
+			out << name << ' ' << target.count() / 1000 << "ms";
+		else
+			out << name << ' ' << target.count() << "us";
+
+		return out.str();
+	}
+
+	void write_histograms(std::ostream &out, const std::vector<histogram> &hs)
+	{
+		out << std::left << std::setw(32) << "overshoot, us" << std::right;
+
+		for (unsigned b = 0; b < buckets; ++b)
+		{
+			std::ostringstream label;
+
+			if (b < buckets - 1)
+				label << '<' << bucket_us[b];
+			else
+				label << ">=" << bucket_us[b - 1];
+
+			out << std::setw(7) << label.str();
+		}
+
+		out << '\n';
+
+		for (std::size_t i = 0; i < hs.size(); ++i)
+		{
+			unsigned long counts[buckets] = {};
+
+			for (std::size_t j = 0; j < hs[i].overshoot_ns.size(); ++j)
+			{
+				unsigned b = 0;
+
+				while (b < buckets - 1 && hs[i].overshoot_ns[j] >= bucket_us[b] * 1000)
+					++b;
+
+				++counts[b];
+			}
+
+			out << std::left << std::setw(32) << hs[i].name << std::right;
+
+			for (unsigned b = 0; b < buckets; ++b)
+				out << std::setw(7) << counts[b];
+
+			out << '\n';
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const chrono::microseconds targets[] = {
+		chrono::microseconds(1), chrono::microseconds(10), chrono::microseconds(100),
+		chrono::milliseconds(1), chrono::milliseconds(10)
+	};
+	const char *modes[] = { "sleep_for", "sleep_until", "precise_sleep_for" };
+
+	// One sleep per run, so the percentiles are over single sleeps; no
+	// warm-up runs, the calibration call is the only untimed one.
+	bench::options opts;
+
+	opts.warmup_runs = 0;
+	opts.runs = 100;
+	opts.min_run_time = chrono::nanoseconds(0);
+
+	bench::runner r(opts);
+	std::vector<histogram> hs(3 * 5);
+
+	for (unsigned m = 0; m < 3; ++m)
+	{
+		for (unsigned t = 0; t < 5; ++t)
+		{
+			histogram &h = hs[m * 5 + t];
+
+			h.name = sleep_name(modes[m], targets[t]);
+			r.run(h.name, timed_sleep(static_cast<sleep_mode>(m), targets[t], h));
+			h.overshoot_ns.erase(h.overshoot_ns.begin()); // the calibration call
+		}
+	}
+
+	r.write_text(std::cout);
+
+	std::cout << '\n';
+	write_histograms(std::cout, hs);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,145 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/spsc_queue"
+#include "../include/atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+using namespace stdex;
+
+namespace
+{
+	const std::size_t capacity = 1024;
+	const std::size_t batch = 32; // messages per iteration of the bulk runs
+
+	struct shared
+	{
+		spsc_queue<unsigned long> queue;
+		atomic<unsigned> tickets;
+
+		explicit shared(bool blocking) :
+			queue(capacity, blocking),
+			tickets(0)
+		{}
+	};
+
+	// Of the two threads the first to call pushes, the other pops; an
+	// iteration is one message.
+	struct handoff
+	{
+		explicit handoff(shared &s) :
+			s(&s),
+			role(-1),
+			value(0)
+		{}
+
+		void operator()()
+		{
+			if (role < 0)
+				role = static_cast<int>(s->tickets.fetch_add(1) % 2);
+
+			if (role == 0)
+				s->queue.push(++value);
+			else
+				s->queue.pop(value);
+		}
+
+		shared *s;
+		int role;
+		unsigned long value;
+	};
+
+	// The same with push_n and pop_n, an iteration is a batch. The bulk
+	// functions never wait: a side that gets nothing done waits in push()
+	// or front_wait(), or on a single processor it would spin through the
+	// time slice of the thread it is waiting for.
+	struct bulk_handoff
+	{
+		explicit bulk_handoff(shared &s) :
+			s(&s),
+			role(-1)
+		{
+			for (std::size_t i = 0; i < batch; ++i)
+				values[i] = i;
+		}
+
+		void operator()()
+		{
+			if (role < 0)
+				role = static_cast<int>(s->tickets.fetch_add(1) % 2);
+
+			std::size_t done = 0;
+
+			while (done < batch)
+			{
+				if (role == 0)
+				{
+					std::size_t n = s->queue.push_n(values + done, batch - done);
+
+					if (!n)
+					{
+						s->queue.push(values[done]);
+						n = 1;
+					}
+
+					done += n;
+				}
+				else
+				{
+					std::size_t n = s->queue.pop_n(values + done, batch - done);
+
+					if (!n)
+						s->queue.front_wait();
+
+					done += n;
+				}
+			}
+		}
+
+		shared *s;
+		int role;
+		unsigned long values[batch];
+	};
+
+	void handoff_suite(bench::runner &r, bool blocking)
+	{
+		shared single(blocking);
+		shared bulk(blocking);
+
+		r.run_parallel(blocking ? "push/pop, blocking" : "push/pop, yielding", 2, handoff(single));
+		r.run_parallel(blocking ? "push_n/pop_n 32, blocking" : "push_n/pop_n 32, yielding", 2, bulk_handoff(bulk));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	handoff_suite(r, true);
+	handoff_suite(r, false);
+
+	r.write_text(std::cout);
+
+	std::cout << '\n';
+
+	for (std::size_t i = 0; i < r.results().size(); ++i)
+	{
+		const bench::result &res = r.results()[i];
+		const std::size_t messages = res.name.find("push_n") == std::string::npos ? 1 : batch;
+
+		std::cout << res.name << ": " << static_cast<unsigned long>(messages * 1e9 / res.p50) << " msgs/s\n";
+	}
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,260 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/thread"
+#include "../include/chrono"
+
+// POSIX includes
+#include <pthread.h>
+
+// std includes
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+#include <thread>
+#endif
+
+using namespace stdex;
+
+namespace
+{
+	// Time from the thread constructor call to the thread function: the
+	// function stamps entered, the spawner adds a sample once it joined.
+	struct spawn_latency
+	{
+		std::string name;
+		chrono::steady_clock::time_point entered;
+		std::vector<double> samples_ns;
+
+		explicit spawn_latency(const std::string &name) :
+			name(name)
+		{}
+
+		void add(const chrono::steady_clock::time_point &start)
+		{
+			samples_ns.push_back(static_cast<double>(
+				chrono::duration_cast<chrono::nanoseconds>(entered - start).count()));
+		}
+
+		double percentile(double p)
+		{
+			std::sort(samples_ns.begin(), samples_ns.end());
+			return samples_ns[static_cast<std::size_t>(p * (samples_ns.size() - 1))];
+		}
+	};
+
+	void mark(void *arg)
+	{
+		static_cast<spawn_latency*>(arg)->entered = chrono::steady_clock::now();
+	}
+
+	void* pthread_mark(void *arg)
+	{
+		mark(arg);
+		return 0;
+	}
+
+	struct worker
+	{
+		explicit worker(spawn_latency &l) :
+			l(&l)
+		{}
+
+		void run()
+		{
+			mark(l);
+		}
+
+		void run_with(spawn_latency *data)
+		{
+			mark(data);
+		}
+
+		spawn_latency *l;
+	};
+
+	// Starts a thread and joins it.
+	struct spawn_join
+	{
+		explicit spawn_join(spawn_latency &l) :
+			l(&l)
+		{}
+
+		void operator()()
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			thread t(&mark, l);
+
+			t.join();
+			l->add(start);
+		}
+
+		spawn_latency *l;
+	};
+
+	struct spawn_join_member
+	{
+		explicit spawn_join_member(spawn_latency &l) :
+			l(&l)
+		{}
+
+		void operator()()
+		{
+			worker w(*l);
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			thread t(&worker::run, &w);
+
+			t.join();
+			l->add(start);
+		}
+
+		spawn_latency *l;
+	};
+
+	struct spawn_join_member_data
+	{
+		explicit spawn_join_member_data(spawn_latency &l) :
+			l(&l)
+		{}
+
+		void operator()()
+		{
+			worker w(*l);
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			thread t(&worker::run_with, &w, l);
+
+			t.join();
+			l->add(start);
+		}
+
+		spawn_latency *l;
+	};
+
+	// The floor: pthread_create without a start record.
+	struct pthread_spawn_join
+	{
+		explicit pthread_spawn_join(spawn_latency &l) :
+			l(&l)
+		{}
+
+		void operator()()
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			pthread_t t;
+
+			if (pthread_create(&t, 0, &pthread_mark, l) == 0)
+			{
+				pthread_join(t, 0);
+				l->add(start);
+			}
+		}
+
+		spawn_latency *l;
+	};
+
+	struct current_id
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(this_thread::get_id());
+		}
+	};
+
+	struct yield
+	{
+		void operator()()
+		{
+			this_thread::yield();
+		}
+	};
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	struct std_spawn_join
+	{
+		explicit std_spawn_join(spawn_latency &l) :
+			l(&l)
+		{}
+
+		void operator()()
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			std::thread t(&mark, static_cast<void*>(l));
+
+			t.join();
+			l->add(start);
+		}
+
+		spawn_latency *l;
+	};
+
+	struct std_current_id
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(std::this_thread::get_id());
+		}
+	};
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	std::vector<spawn_latency*> latencies;
+
+	latencies.push_back(new spawn_latency("thread"));
+	r.run("thread spawn/join", spawn_join(*latencies.back()));
+	latencies.push_back(new spawn_latency("thread, member function"));
+	r.run("thread spawn/join, member function", spawn_join_member(*latencies.back()));
+	latencies.push_back(new spawn_latency("thread, member function with data"));
+	r.run("thread spawn/join, member function with data", spawn_join_member_data(*latencies.back()));
+	latencies.push_back(new spawn_latency("pthread_create"));
+	r.run("pthread_create/pthread_join", pthread_spawn_join(*latencies.back()));
+	r.run("this_thread::get_id", current_id());
+	r.run("this_thread::yield", yield());
+
+	// get_id must not serialize threads: flat from 1 thread to all of them
+	unsigned cores = thread::hardware_concurrency();
+
+	if (!cores)
+		cores = 1;
+
+	for (unsigned threads = 1; threads < cores; threads *= 2)
+		r.run_parallel("this_thread::get_id", threads, current_id());
+	r.run_parallel("this_thread::get_id", cores, current_id());
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	latencies.push_back(new spawn_latency("std::thread"));
+	r.run("std::thread spawn/join", std_spawn_join(*latencies.back()));
+	r.run("std::this_thread::get_id", std_current_id());
+#endif
+
+	r.write_text(std::cout);
+
+	std::cout << '\n' << std::left << std::setw(40) << "spawn latency" << std::right
+		<< std::setw(12) << "p50 ns" << std::setw(12) << "p90 ns" << std::setw(12) << "p99 ns" << '\n';
+
+	for (std::size_t i = 0; i < latencies.size(); ++i)
+	{
+		spawn_latency &l = *latencies[i];
+
+		std::cout << std::left << std::setw(40) << l.name << std::right << std::fixed << std::setprecision(0)
+			<< std::setw(12) << l.percentile(0.5) << std::setw(12) << l.percentile(0.9)
+			<< std::setw(12) << l.percentile(0.99) << '\n';
+
+		delete latencies[i];
+	}
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
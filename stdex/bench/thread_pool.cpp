@@ -0,0 +1,117 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/thread_pool"
+#include "../include/thread"
+#include "../include/atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace stdex;
+
+namespace
+{
+	const unsigned batch = 100; // tasks per iteration
+
+	atomic<unsigned long> tasks_run(0);
+
+	void tiny_task(void*)
+	{
+		tasks_run.fetch_add(1, memory_order_relaxed);
+	}
+
+	// Submits a batch from outside the pool and waits for it.
+	struct pool_batch
+	{
+		explicit pool_batch(thread_pool &pool) :
+			pool(&pool)
+		{}
+
+		void operator()()
+		{
+			for (unsigned i = 0; i < batch; ++i)
+				pool->submit(&tiny_task, 0);
+
+			pool->wait();
+		}
+
+		thread_pool *pool;
+	};
+
+	// Submits one task that submits the batch from a worker, onto its own
+	// deque where the other workers steal from.
+	struct pool_fork
+	{
+		explicit pool_fork(thread_pool &pool) :
+			pool(&pool)
+		{}
+
+		void fork()
+		{
+			for (unsigned i = 0; i < batch; ++i)
+				pool->submit(&tiny_task, 0);
+		}
+
+		void operator()()
+		{
+			pool->submit(&pool_fork::fork, this);
+			pool->wait();
+		}
+
+		thread_pool *pool;
+	};
+
+	// Starts a thread per task of the batch, then joins them.
+	struct thread_per_task
+	{
+		void operator()()
+		{
+			std::vector<thread*> threads;
+
+			threads.reserve(batch);
+
+			for (unsigned i = 0; i < batch; ++i)
+				threads.push_back(new thread(&tiny_task, 0));
+
+			for (unsigned i = 0; i < batch; ++i)
+			{
+				threads[i]->join();
+				delete threads[i];
+			}
+		}
+	};
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	thread_pool pool;
+
+	r.run("thread_pool, 100 tasks submitted", pool_batch(pool));
+	r.run("thread_pool, 100 tasks forked by a task", pool_fork(pool));
+	r.run("thread per task, 100 tasks", thread_per_task());
+
+	r.write_text(std::cout);
+
+	std::cout << "\nworkers: " << pool.size() << '\n';
+
+	for (std::size_t i = 0; i < r.results().size(); ++i)
+	{
+		const bench::result &res = r.results()[i];
+
+		std::cout << res.name << ": " << static_cast<unsigned long>(batch * 1e9 / res.p50) << " tasks/s\n";
+	}
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/thread_specific_ptr"
+#include "../include/thread"
+
+// POSIX includes
+#include <pthread.h>
+
+// std includes
+#include <fstream>
+#include <iostream>
+
+using namespace stdex;
+
+namespace
+{
+	struct counter_tag;
+	typedef thread_local_pod<long, counter_tag> counter;
+
+	struct pod_get
+	{
+		void operator()()
+		{
+			bench::do_not_optimize(counter::get());
+		}
+	};
+
+	struct pod_increment
+	{
+		void operator()()
+		{
+			counter::set(counter::get() + 1);
+			bench::clobber_memory();
+		}
+	};
+
+	struct ptr_get
+	{
+		explicit ptr_get(thread_specific_ptr<long> &p) :
+			p(&p)
+		{}
+
+		void operator()()
+		{
+			if (!p->get())
+				p->reset(new long(0));
+
+			bench::do_not_optimize(p->get());
+		}
+
+		thread_specific_ptr<long> *p;
+	};
+
+	// A new value each iteration: an allocation and the cleanup of the old one.
+	struct ptr_reset
+	{
+		explicit ptr_reset(thread_specific_ptr<long> &p) :
+			p(&p)
+		{}
+
+		void operator()()
+		{
+			p->reset(new long(0));
+		}
+
+		thread_specific_ptr<long> *p;
+	};
+
+	// The pthread key thread_specific_ptr is built on, used directly.
+	class posix_key
+	{
+	public:
+		posix_key()
+		{
+			pthread_key_create(&_key, 0);
+		}
+
+		~posix_key()
+		{
+			pthread_key_delete(_key);
+		}
+
+		pthread_key_t get() const
+		{
+			return _key;
+		}
+
+	private:
+		pthread_key_t _key;
+	};
+
+	struct getspecific
+	{
+		explicit getspecific(const posix_key &k) :
+			k(&k)
+		{}
+
+		void operator()()
+		{
+			bench::do_not_optimize(pthread_getspecific(k->get()));
+		}
+
+		const posix_key *k;
+	};
+
+	struct setspecific
+	{
+		explicit setspecific(const posix_key &k) :
+			k(&k)
+		{}
+
+		void operator()()
+		{
+			pthread_setspecific(k->get(), this);
+		}
+
+		const posix_key *k;
+	};
+
+#ifdef _STDEX_THREAD_LOCAL
+	_STDEX_THREAD_LOCAL long compiler_value;
+
+	struct compiler_increment
+	{
+		void operator()()
+		{
+			++compiler_value;
+			bench::clobber_memory();
+		}
+	};
+#endif
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	thread_local long std_value;
+
+	struct std_increment
+	{
+		void operator()()
+		{
+			++std_value;
+			bench::clobber_memory();
+		}
+	};
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+	thread_specific_ptr<long> ptr;
+	posix_key key;
+	unsigned threads = thread::hardware_concurrency();
+
+	if (threads < 2)
+		threads = 2;
+
+	r.run("thread_local_pod get", pod_get());
+	r.run("thread_local_pod get/set", pod_increment());
+	r.run("thread_specific_ptr get", ptr_get(ptr));
+	r.run("thread_specific_ptr reset", ptr_reset(ptr));
+	r.run("pthread_getspecific", getspecific(key));
+	r.run("pthread_setspecific", setspecific(key));
+
+#ifdef _STDEX_THREAD_LOCAL
+	r.run("_STDEX_THREAD_LOCAL increment", compiler_increment());
+#endif
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+	r.run("thread_local increment", std_increment());
+#endif
+
+	// Each thread has its own value, so these should scale with the threads
+	r.run_parallel("thread_local_pod get/set", threads, pod_increment());
+	r.run_parallel("thread_specific_ptr get", threads, ptr_get(ptr));
+
+	r.write_text(std::cout);
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+// stdex includes
+#include "../include/bench"
+#include "../include/timer_service"
+#include "../include/chrono"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace stdex;
+
+namespace
+{
+	void never_runs(void*)
+	{}
+
+	// Schedules a timer an hour away and cancels the one scheduled pending
+	// iterations before, so the service keeps that many timers pending.
+	struct schedule_cancel
+	{
+		schedule_cancel(timer_service &timers, std::vector<timer_service::timer_id> &ring) :
+			timers(&timers),
+			ring(&ring),
+			next(0)
+		{}
+
+		void operator()()
+		{
+			timer_service::timer_id &slot = (*ring)[next];
+
+			timers->cancel(slot);
+			slot = timers->schedule_after(chrono::seconds(3600), &never_runs, 0);
+
+			if (++next == ring->size())
+				next = 0;
+		}
+
+		timer_service *timers;
+		std::vector<timer_service::timer_id> *ring;
+		std::size_t next;
+	};
+
+	void pending_suite(bench::runner &r, std::size_t pending)
+	{
+		timer_service timers;
+		std::vector<timer_service::timer_id> ring(pending);
+
+		for (std::size_t i = 0; i < pending; ++i)
+			ring[i] = timers.schedule_after(chrono::seconds(3600), &never_runs, 0);
+
+		std::ostringstream name;
+
+		name << "schedule_after + cancel, " << pending << " pending";
+
+		r.run(name.str(), schedule_cancel(timers, ring));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench::runner r;
+
+	pending_suite(r, 1);
+	pending_suite(r, 1000);
+	pending_suite(r, 1000000);
+
+	r.write_text(std::cout);
+
+	std::cout << '\n';
+
+	for (std::size_t i = 0; i < r.results().size(); ++i)
+	{
+		const bench::result &res = r.results()[i];
+
+		std::cout << res.name << ": " << static_cast<unsigned long>(1e9 / res.p50) << " schedule/cancel pairs/s\n";
+	}
+
+	if (argc > 1)
+	{
+		std::ofstream json(argv[1]);
+		r.write_json(json);
+	}
+
+	return 0;
+}
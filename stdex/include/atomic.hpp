@@ -0,0 +1,713 @@
+#ifndef _STDEX_ATOMIC_H
+#define _STDEX_ATOMIC_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./core.h"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+// Size of a cache line: data written by different threads is kept this far
+// apart to avoid false sharing.
+#ifndef _STDEX_CACHE_LINE_SIZE
+	#define _STDEX_CACHE_LINE_SIZE 64
+#endif
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+
+#include <atomic>
+
+namespace stdex
+{
+	using std::memory_order;
+	using std::memory_order_relaxed;
+	using std::memory_order_consume;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::memory_order_acq_rel;
+	using std::memory_order_seq_cst;
+
+	using std::atomic;
+	using std::atomic_flag;
+	using std::atomic_thread_fence;
+	using std::atomic_signal_fence;
+
+	using std::atomic_bool;
+	using std::atomic_char;
+	using std::atomic_schar;
+	using std::atomic_uchar;
+	using std::atomic_short;
+	using std::atomic_ushort;
+	using std::atomic_int;
+	using std::atomic_uint;
+	using std::atomic_long;
+	using std::atomic_ulong;
+	using std::atomic_size_t;
+	using std::atomic_ptrdiff_t;
+} // namespace stdex
+
+#else // no C++11 support
+
+#ifdef _MSC_VER
+#include <intrin.h> // for _Interlocked* intrinsics and _ReadWriteBarrier
+#endif
+
+namespace stdex
+{
+	//! Memory ordering constraints of atomic operations.
+	//! The values match the __ATOMIC_* constants of GCC.
+	enum memory_order
+	{
+		memory_order_relaxed,
+		memory_order_consume,
+		memory_order_acquire,
+		memory_order_release,
+		memory_order_acq_rel,
+		memory_order_seq_cst
+	};
+
+	namespace detail
+	{
+		// Strongest order allowed for the load of a failed compare-and-swap.
+		inline memory_order _failure_order(memory_order order) NOEXCEPT_FUNCTION
+		{
+			if (order == memory_order_acq_rel)
+				return memory_order_acquire;
+			if (order == memory_order_release)
+				return memory_order_relaxed;
+			return order;
+		}
+
+#if defined(__ATOMIC_SEQ_CST) // GCC 4.7+, clang: __atomic builtins
+
+		template<class _Tp>
+		inline bool _atomic_is_lock_free(const volatile _Tp*) NOEXCEPT_FUNCTION
+		{
+			return __atomic_always_lock_free(sizeof(_Tp), 0);
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_load(const volatile _Tp *p, memory_order order) NOEXCEPT_FUNCTION
+		{
+			return __atomic_load_n(p, int(order));
+		}
+
+		template<class _Tp>
+		inline void _atomic_store(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			__atomic_store_n(p, value, int(order));
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_exchange(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			return __atomic_exchange_n(p, value, int(order));
+		}
+
+		template<class _Tp>
+		inline bool _atomic_compare_exchange(volatile _Tp *p, _Tp &expected, _Tp desired, bool weak,
+			memory_order success, memory_order failure) NOEXCEPT_FUNCTION
+		{
+			return __atomic_compare_exchange_n(p, &expected, desired, weak, int(success), int(failure));
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_add(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			return __atomic_fetch_add(p, value, int(order));
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_sub(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			return __atomic_fetch_sub(p, value, int(order));
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_and(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			return __atomic_fetch_and(p, value, int(order));
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_or(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			return __atomic_fetch_or(p, value, int(order));
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_xor(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			return __atomic_fetch_xor(p, value, int(order));
+		}
+
+		inline void _atomic_thread_fence(memory_order order) NOEXCEPT_FUNCTION
+		{
+			__atomic_thread_fence(int(order));
+		}
+
+		inline void _atomic_signal_fence(memory_order order) NOEXCEPT_FUNCTION
+		{
+			__atomic_signal_fence(int(order));
+		}
+
+#else // everything is built on a compare-and-swap with full barrier semantics
+
+	#if defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1)) // __sync builtins
+
+		#define _STDEX_ATOMIC_LOCK_FREE true
+
+		// Returns the previous value.
+		template<class _Tp>
+		inline _Tp _atomic_cas(volatile _Tp *p, _Tp expected, _Tp desired) NOEXCEPT_FUNCTION
+		{
+			return __sync_val_compare_and_swap(p, expected, desired);
+		}
+
+		inline void _atomic_full_fence() NOEXCEPT_FUNCTION
+		{
+			__sync_synchronize();
+		}
+
+		inline void _atomic_compiler_fence() NOEXCEPT_FUNCTION
+		{
+			__asm__ __volatile__("" ::: "memory");
+		}
+
+	#elif defined(_MSC_VER)
+
+		#define _STDEX_ATOMIC_LOCK_FREE true
+
+		template<std::size_t _Size> struct _interlocked;
+
+		template<> struct _interlocked<1>
+		{
+			typedef char type;
+			static type cas(volatile type *p, type expected, type desired) { return _InterlockedCompareExchange8(p, desired, expected); }
+		};
+
+		template<> struct _interlocked<2>
+		{
+			typedef short type;
+			static type cas(volatile type *p, type expected, type desired) { return _InterlockedCompareExchange16(p, desired, expected); }
+		};
+
+		template<> struct _interlocked<4>
+		{
+			typedef long type;
+			static type cas(volatile type *p, type expected, type desired) { return _InterlockedCompareExchange(p, desired, expected); }
+		};
+
+		template<> struct _interlocked<8>
+		{
+			typedef __int64 type;
+			static type cas(volatile type *p, type expected, type desired) { return _InterlockedCompareExchange64(p, desired, expected); }
+		};
+
+		// Same bits, other type (pointers and bool have no interlocked functions).
+		template<class _To, class _From>
+		inline _To _atomic_bit_cast(_From value) NOEXCEPT_FUNCTION
+		{
+			union { _From from; _To to; } u;
+			u.from = value;
+			return u.to;
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_cas(volatile _Tp *p, _Tp expected, _Tp desired) NOEXCEPT_FUNCTION
+		{
+			typedef _interlocked<sizeof(_Tp)> interlocked;
+			typedef typename interlocked::type int_type;
+
+			return _atomic_bit_cast<_Tp>(
+				interlocked::cas(reinterpret_cast<volatile int_type*>(p),
+					_atomic_bit_cast<int_type>(expected), _atomic_bit_cast<int_type>(desired)));
+		}
+
+		inline void _atomic_full_fence() NOEXCEPT_FUNCTION
+		{
+			long barrier = 0;
+			_InterlockedExchange(&barrier, 0);
+		}
+
+		inline void _atomic_compiler_fence() NOEXCEPT_FUNCTION
+		{
+			_ReadWriteBarrier();
+		}
+
+	#elif (defined(__GNUC__) || defined(__INTEL_COMPILER) || defined(__SUNPRO_CC)) && (defined(__i386__) || defined(__x86_64__))
+
+		#define _STDEX_ATOMIC_LOCK_FREE true
+
+		// lock cmpxchg works on 1, 2, 4 and (x86-64 only) 8 bytes, the operand
+		// size is taken from the type of desired.
+		template<class _Tp>
+		inline _Tp _atomic_cas(volatile _Tp *p, _Tp expected, _Tp desired) NOEXCEPT_FUNCTION
+		{
+			_Tp prev;
+			__asm__ __volatile__("lock; cmpxchg %2, %1"
+				: "=a" (prev), "+m" (*p)
+				: "q" (desired), "0" (expected)
+				: "memory", "cc");
+			return prev;
+		}
+
+		inline void _atomic_full_fence() NOEXCEPT_FUNCTION
+		{
+	#ifdef __x86_64__
+			__asm__ __volatile__("mfence" ::: "memory");
+	#else
+			__asm__ __volatile__("lock; addl $0, (%%esp)" ::: "memory", "cc");
+	#endif
+		}
+
+		inline void _atomic_compiler_fence() NOEXCEPT_FUNCTION
+		{
+			__asm__ __volatile__("" ::: "memory");
+		}
+
+	#else // serialized through a global lock in atomic.cpp
+
+		#define _STDEX_ATOMIC_LOCK_FREE false
+		#define _STDEX_ATOMIC_USES_LOCK
+
+		void _atomic_lock() NOEXCEPT_FUNCTION;
+		void _atomic_unlock() NOEXCEPT_FUNCTION;
+
+		template<class _Tp>
+		inline _Tp _atomic_cas(volatile _Tp *p, _Tp expected, _Tp desired) NOEXCEPT_FUNCTION
+		{
+			_atomic_lock();
+			_Tp prev = *p;
+			if (prev == expected)
+				*p = desired;
+			_atomic_unlock();
+
+			return prev;
+		}
+
+		inline void _atomic_full_fence() NOEXCEPT_FUNCTION
+		{
+			_atomic_lock();
+			_atomic_unlock();
+		}
+
+		inline void _atomic_compiler_fence() NOEXCEPT_FUNCTION
+		{
+			_atomic_full_fence();
+		}
+
+	#endif
+
+		template<class _Tp>
+		inline bool _atomic_is_lock_free(const volatile _Tp*) NOEXCEPT_FUNCTION
+		{
+			return _STDEX_ATOMIC_LOCK_FREE;
+		}
+
+		// Plain loads and stores of aligned words are atomic on all supported
+		// targets, the fences only add the ordering.
+		template<class _Tp>
+		inline _Tp _atomic_load(const volatile _Tp *p, memory_order order) NOEXCEPT_FUNCTION
+		{
+			if (order == memory_order_seq_cst)
+				_atomic_full_fence();
+
+			_Tp value = *p;
+
+			if (order != memory_order_relaxed)
+				_atomic_full_fence();
+
+			return value;
+		}
+
+		template<class _Tp>
+		inline void _atomic_store(volatile _Tp *p, _Tp value, memory_order order) NOEXCEPT_FUNCTION
+		{
+			if (order != memory_order_relaxed)
+				_atomic_full_fence();
+
+			*p = value;
+
+			if (order == memory_order_seq_cst)
+				_atomic_full_fence();
+		}
+
+		template<class _Tp>
+		inline bool _atomic_compare_exchange(volatile _Tp *p, _Tp &expected, _Tp desired, bool,
+			memory_order, memory_order) NOEXCEPT_FUNCTION
+		{
+			_Tp prev = _atomic_cas(p, expected, desired);
+
+			if (prev == expected)
+				return true;
+
+			expected = prev;
+			return false;
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_exchange(volatile _Tp *p, _Tp value, memory_order) NOEXCEPT_FUNCTION
+		{
+			_Tp old = *p;
+			for (_Tp prev; (prev = _atomic_cas(p, old, value)) != old; old = prev);
+			return old;
+		}
+
+		// Read-modify-write through a compare-and-swap loop.
+		template<class _Tp, class _Operation>
+		inline _Tp _atomic_fetch_op(volatile _Tp *p, _Tp value, _Operation op) NOEXCEPT_FUNCTION
+		{
+			_Tp old = *p;
+			for (_Tp prev; (prev = _atomic_cas(p, old, op(old, value))) != old; old = prev);
+			return old;
+		}
+
+		struct _atomic_op_add { template<class _Tp> _Tp operator()(_Tp a, _Tp b) const { return a + b; } };
+		struct _atomic_op_sub { template<class _Tp> _Tp operator()(_Tp a, _Tp b) const { return a - b; } };
+		struct _atomic_op_and { template<class _Tp> _Tp operator()(_Tp a, _Tp b) const { return a & b; } };
+		struct _atomic_op_or { template<class _Tp> _Tp operator()(_Tp a, _Tp b) const { return a | b; } };
+		struct _atomic_op_xor { template<class _Tp> _Tp operator()(_Tp a, _Tp b) const { return a ^ b; } };
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_add(volatile _Tp *p, _Tp value, memory_order) NOEXCEPT_FUNCTION
+		{
+	#if defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+			return __sync_fetch_and_add(p, value);
+	#else
+			return _atomic_fetch_op(p, value, _atomic_op_add());
+	#endif
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_sub(volatile _Tp *p, _Tp value, memory_order) NOEXCEPT_FUNCTION
+		{
+	#if defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+			return __sync_fetch_and_sub(p, value);
+	#else
+			return _atomic_fetch_op(p, value, _atomic_op_sub());
+	#endif
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_and(volatile _Tp *p, _Tp value, memory_order) NOEXCEPT_FUNCTION
+		{
+			return _atomic_fetch_op(p, value, _atomic_op_and());
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_or(volatile _Tp *p, _Tp value, memory_order) NOEXCEPT_FUNCTION
+		{
+			return _atomic_fetch_op(p, value, _atomic_op_or());
+		}
+
+		template<class _Tp>
+		inline _Tp _atomic_fetch_xor(volatile _Tp *p, _Tp value, memory_order) NOEXCEPT_FUNCTION
+		{
+			return _atomic_fetch_op(p, value, _atomic_op_xor());
+		}
+
+		inline void _atomic_thread_fence(memory_order order) NOEXCEPT_FUNCTION
+		{
+			if (order != memory_order_relaxed)
+				_atomic_full_fence();
+		}
+
+		inline void _atomic_signal_fence(memory_order order) NOEXCEPT_FUNCTION
+		{
+			if (order != memory_order_relaxed)
+				_atomic_compiler_fence();
+		}
+
+		#undef _STDEX_ATOMIC_LOCK_FREE
+
+#endif // __ATOMIC_SEQ_CST
+
+		// Operations common to all atomic types.
+		template<class _Tp>
+		class _atomic_base
+		{
+		public:
+			typedef _Tp value_type;
+
+			bool is_lock_free() const NOEXCEPT_FUNCTION
+			{
+				return _atomic_is_lock_free(&_value);
+			}
+
+			void store(_Tp value, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+			{
+				_atomic_store(&_value, value, order);
+			}
+
+			_Tp load(memory_order order = memory_order_seq_cst) const NOEXCEPT_FUNCTION
+			{
+				return _atomic_load(&_value, order);
+			}
+
+			operator _Tp() const NOEXCEPT_FUNCTION
+			{
+				return load();
+			}
+
+			_Tp exchange(_Tp value, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+			{
+				return _atomic_exchange(&_value, value, order);
+			}
+
+			bool compare_exchange_weak(_Tp &expected, _Tp desired, memory_order success, memory_order failure) NOEXCEPT_FUNCTION
+			{
+				return _atomic_compare_exchange(&_value, expected, desired, true, success, failure);
+			}
+
+			bool compare_exchange_weak(_Tp &expected, _Tp desired, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+			{
+				return _atomic_compare_exchange(&_value, expected, desired, true, order, _failure_order(order));
+			}
+
+			bool compare_exchange_strong(_Tp &expected, _Tp desired, memory_order success, memory_order failure) NOEXCEPT_FUNCTION
+			{
+				return _atomic_compare_exchange(&_value, expected, desired, false, success, failure);
+			}
+
+			bool compare_exchange_strong(_Tp &expected, _Tp desired, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+			{
+				return _atomic_compare_exchange(&_value, expected, desired, false, order, _failure_order(order));
+			}
+
+		protected:
+			volatile _Tp _value;
+
+			_atomic_base() NOEXCEPT_FUNCTION
+			{}
+
+			_atomic_base(_Tp value) NOEXCEPT_FUNCTION:
+				_value(value)
+			{}
+
+		private:
+			_atomic_base(const _atomic_base&) DELETED_FUNCTION;
+			_atomic_base& operator=(const _atomic_base&) DELETED_FUNCTION;
+		};
+	}
+
+	//! Atomic class.
+	//! Value of integral type that can be read and modified by several threads
+	//! at once without a lock. Operations take a memory_order argument that
+	//! defaults to the sequentially consistent memory_order_seq_cst. Example
+	//! usage:
+	//! @code
+	//! atomic<long> counter(0);
+	//! ...
+	//! counter.fetch_add(1, memory_order_relaxed); // or ++counter;
+	//! @endcode
+	//! @note Implemented with the __atomic or __sync builtins of GCC and
+	//! clang, the _Interlocked intrinsics of Visual C++ or x86 inline assembly.
+	//! Other compilers fall back to a global lock, in which case
+	//! @c is_lock_free() returns @c false. With C++ 11 support stdex::atomic is
+	//! std::atomic.
+	//! @note Like in C++ 11 the default constructor leaves the value
+	//! uninitialized, except for objects with static storage duration which
+	//! are zero-initialized.
+	template<class _Tp>
+	class atomic:
+		public detail::_atomic_base<_Tp>
+	{
+		typedef detail::_atomic_base<_Tp> _base;
+
+	public:
+		atomic() NOEXCEPT_FUNCTION
+		{}
+
+		atomic(_Tp value) NOEXCEPT_FUNCTION:
+			_base(value)
+		{}
+
+		_Tp operator=(_Tp value) NOEXCEPT_FUNCTION
+		{
+			this->store(value);
+			return value;
+		}
+
+		//! Atomically add @a value and return the previous value.
+		_Tp fetch_add(_Tp value, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			return detail::_atomic_fetch_add(&this->_value, value, order);
+		}
+
+		//! Atomically subtract @a value and return the previous value.
+		_Tp fetch_sub(_Tp value, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			return detail::_atomic_fetch_sub(&this->_value, value, order);
+		}
+
+		_Tp fetch_and(_Tp value, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			return detail::_atomic_fetch_and(&this->_value, value, order);
+		}
+
+		_Tp fetch_or(_Tp value, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			return detail::_atomic_fetch_or(&this->_value, value, order);
+		}
+
+		_Tp fetch_xor(_Tp value, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			return detail::_atomic_fetch_xor(&this->_value, value, order);
+		}
+
+		_Tp operator++() NOEXCEPT_FUNCTION { return fetch_add(1) + 1; }
+		_Tp operator++(int) NOEXCEPT_FUNCTION { return fetch_add(1); }
+		_Tp operator--() NOEXCEPT_FUNCTION { return fetch_sub(1) - 1; }
+		_Tp operator--(int) NOEXCEPT_FUNCTION { return fetch_sub(1); }
+
+		_Tp operator+=(_Tp value) NOEXCEPT_FUNCTION { return fetch_add(value) + value; }
+		_Tp operator-=(_Tp value) NOEXCEPT_FUNCTION { return fetch_sub(value) - value; }
+		_Tp operator&=(_Tp value) NOEXCEPT_FUNCTION { return fetch_and(value) & value; }
+		_Tp operator|=(_Tp value) NOEXCEPT_FUNCTION { return fetch_or(value) | value; }
+		_Tp operator^=(_Tp value) NOEXCEPT_FUNCTION { return fetch_xor(value) ^ value; }
+	};
+
+	template<>
+	class atomic<bool>:
+		public detail::_atomic_base<bool>
+	{
+		typedef detail::_atomic_base<bool> _base;
+
+	public:
+		atomic() NOEXCEPT_FUNCTION
+		{}
+
+		atomic(bool value) NOEXCEPT_FUNCTION:
+			_base(value)
+		{}
+
+		bool operator=(bool value) NOEXCEPT_FUNCTION
+		{
+			this->store(value);
+			return value;
+		}
+	};
+
+	template<class _Tp>
+	class atomic<_Tp*>:
+		public detail::_atomic_base<_Tp*>
+	{
+		typedef detail::_atomic_base<_Tp*> _base;
+
+	public:
+		atomic() NOEXCEPT_FUNCTION
+		{}
+
+		atomic(_Tp *value) NOEXCEPT_FUNCTION:
+			_base(value)
+		{}
+
+		_Tp* operator=(_Tp *value) NOEXCEPT_FUNCTION
+		{
+			this->store(value);
+			return value;
+		}
+
+		//! Atomically advance the pointer by @a n elements and return the previous value.
+		_Tp* fetch_add(std::ptrdiff_t n, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			_Tp *old = this->load(memory_order_relaxed);
+			while (!this->compare_exchange_weak(old, old + n, order, memory_order_relaxed));
+			return old;
+		}
+
+		_Tp* fetch_sub(std::ptrdiff_t n, memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			return fetch_add(-n, order);
+		}
+
+		_Tp* operator++() NOEXCEPT_FUNCTION { return fetch_add(1) + 1; }
+		_Tp* operator++(int) NOEXCEPT_FUNCTION { return fetch_add(1); }
+		_Tp* operator--() NOEXCEPT_FUNCTION { return fetch_sub(1) - 1; }
+		_Tp* operator--(int) NOEXCEPT_FUNCTION { return fetch_sub(1); }
+
+		_Tp* operator+=(std::ptrdiff_t n) NOEXCEPT_FUNCTION { return fetch_add(n) + n; }
+		_Tp* operator-=(std::ptrdiff_t n) NOEXCEPT_FUNCTION { return fetch_sub(n) - n; }
+	};
+
+	typedef atomic<bool> atomic_bool;
+	typedef atomic<char> atomic_char;
+	typedef atomic<signed char> atomic_schar;
+	typedef atomic<unsigned char> atomic_uchar;
+	typedef atomic<short> atomic_short;
+	typedef atomic<unsigned short> atomic_ushort;
+	typedef atomic<int> atomic_int;
+	typedef atomic<unsigned int> atomic_uint;
+	typedef atomic<long> atomic_long;
+	typedef atomic<unsigned long> atomic_ulong;
+	typedef atomic<std::size_t> atomic_size_t;
+	typedef atomic<std::ptrdiff_t> atomic_ptrdiff_t;
+
+	//! Atomic flag class.
+	//! The simplest lock-free boolean: set and test in one step, or clear.
+	//! @note The default constructor clears the flag (as in C++ 20). With
+	//! C++ 11 support, where stdex::atomic_flag is std::atomic_flag, initialize
+	//! it with ATOMIC_FLAG_INIT instead.
+	class atomic_flag
+	{
+	public:
+		atomic_flag() NOEXCEPT_FUNCTION:
+			_flag(0)
+		{}
+
+		//! Set the flag and return its previous state.
+		bool test_and_set(memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			return detail::_atomic_exchange(&_flag, 1, order) != 0;
+		}
+
+		//! Clear the flag.
+		void clear(memory_order order = memory_order_seq_cst) NOEXCEPT_FUNCTION
+		{
+			detail::_atomic_store(&_flag, 0, order);
+		}
+
+	private:
+		volatile int _flag;
+
+		atomic_flag(const atomic_flag&) DELETED_FUNCTION;
+		atomic_flag& operator=(const atomic_flag&) DELETED_FUNCTION;
+	};
+
+	//! Memory fence establishing the ordering @a order without an atomic operation.
+	inline void atomic_thread_fence(memory_order order) NOEXCEPT_FUNCTION
+	{
+		detail::_atomic_thread_fence(order);
+	}
+
+	//! Fence between a thread and a signal handler executed in the same thread
+	//! (compiler reordering only).
+	inline void atomic_signal_fence(memory_order order) NOEXCEPT_FUNCTION
+	{
+		detail::_atomic_signal_fence(order);
+	}
+} // namespace stdex
+
+#endif // _STDEX_NATIVE_CPP11_SUPPORT
+
+#endif // _STDEX_ATOMIC_H
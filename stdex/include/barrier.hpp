@@ -0,0 +1,152 @@
+#ifndef _STDEX_BARRIER_H
+#define _STDEX_BARRIER_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+#include <climits>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	namespace detail
+	{
+		struct _barrier_no_completion
+		{
+			void operator()() const {}
+		};
+	}
+
+	//! Barrier class.
+	//! Reusable rendezvous of a fixed number of threads. Each phase ends when
+	//! the expected number of threads arrived: the last one calls the
+	//! completion function, then all waiting threads are released and the
+	//! next phase begins. The phase number is a futex word, so only the last
+	//! arrival of a phase may make a system call, and only if threads sleep.
+	//! Example usage:
+	//! @code
+	//! barrier<> step(workers);
+	//!
+	//! // every worker
+	//! for (int i = 0; i < steps; ++i)
+	//! {
+	//!   compute(i);
+	//!   step.arrive_and_wait();
+	//! }
+	//! @endcode
+	//! @tparam _CompletionFunction Function object called without arguments
+	//! at the end of each phase.
+	template<class _CompletionFunction = detail::_barrier_no_completion>
+	class barrier
+	{
+	public:
+		//! Token returned by @c arrive() to wait for the end of the phase.
+		typedef int arrival_token;
+
+		//! Maximal expected count supported.
+		static std::ptrdiff_t (max)() NOEXCEPT_FUNCTION
+		{
+			return INT_MAX;
+		}
+
+		//! Constructor.
+		//! @param[in] expected Number of threads taking part in each phase.
+		//! @param[in] f Completion function.
+		explicit barrier(std::ptrdiff_t expected, _CompletionFunction f = _CompletionFunction()):
+			_phase(0),
+			_remaining(static_cast<int>(expected)),
+			_expected(static_cast<int>(expected)),
+			_waiters(0),
+			_completion(f)
+		{}
+
+		//! Destructor.
+		~barrier()
+		{}
+
+		//! Arrive at the barrier @a update times without waiting.
+		//! @return Token for @c wait().
+		arrival_token arrive(std::ptrdiff_t update = 1)
+		{
+			// the phase can't end before this arrival
+			int phase = _phase.load(memory_order_acquire);
+
+			if (_remaining.fetch_sub(static_cast<int>(update), memory_order_acq_rel) == update)
+			{// the last one
+				_completion();
+
+				_remaining.store(_expected.load(memory_order_relaxed), memory_order_relaxed);
+				_phase.store(phase + 1, memory_order_release);
+
+				// pairs with the fence in wait()
+				atomic_thread_fence(memory_order_seq_cst);
+
+				if (_waiters.load(memory_order_relaxed) != 0)
+					detail::futex_wake(_phase, INT_MAX);
+			}
+
+			return phase;
+		}
+
+		//! Block until the phase the token was returned for has ended.
+		void wait(arrival_token phase) const NOEXCEPT_FUNCTION
+		{
+			while (_phase.load(memory_order_acquire) == phase)
+			{
+				_waiters.fetch_add(1, memory_order_relaxed);
+				atomic_thread_fence(memory_order_seq_cst);
+
+				detail::futex_wait(_phase, phase);
+
+				_waiters.fetch_sub(1, memory_order_relaxed);
+			}
+		}
+
+		//! Arrive at the barrier and wait for the end of the phase.
+		void arrive_and_wait()
+		{
+			wait(arrive());
+		}
+
+		//! Arrive at the barrier and leave it: the following phases expect
+		//! one thread less.
+		void arrive_and_drop()
+		{
+			_expected.fetch_sub(1, memory_order_relaxed);
+			arrive();
+		}
+
+	private:
+		mutable atomic<int> _phase;   //!< Futex word.
+		atomic<int> _remaining;       //!< Arrivals missing in this phase.
+		atomic<int> _expected;        //!< Arrivals expected in the next phase.
+		mutable atomic<int> _waiters; //!< Threads sleeping or about to sleep on _phase.
+		_CompletionFunction _completion;
+
+		barrier(const barrier&) DELETED_FUNCTION;
+		barrier& operator=(const barrier&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_BARRIER_H
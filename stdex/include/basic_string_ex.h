@@ -3,11 +3,18 @@
 
 #include "./core.h"
 #include "./type_traits.hpp"
+#include "./system_error.hpp"
+#include "./types_ex.h"
 
 #include <cstring>
 #include <cctype>
 #include <cstdlib>
 #include <cstdio>
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <limits>
+#include <stdexcept>
 
 #include <iostream>
 #include <string>
@@ -39,52 +46,407 @@ namespace stdex
 			{
 			}
 		};
+
+		template<bool>
+		struct is_negative
+		{
+			template<typename T>
+			inline static bool apply(const T &val)
+			{
+				return val < T(0);
+			}
+		};
+
+		template<>
+		struct is_negative<false>
+		{
+			template<typename T>
+			inline static bool apply(const T &)
+			{
+				return false;
+			}
+		};
+
+		// "00", "01", ..., "99": two digits per division by 100.
+		inline const char* digit_pairs()
+		{
+			static const char pairs[] =
+				"00010203040506070809"
+				"10111213141516171819"
+				"20212223242526272829"
+				"30313233343536373839"
+				"40414243444546474849"
+				"50515253545556575859"
+				"60616263646566676869"
+				"70717273747576777879"
+				"80818283848586878889"
+				"90919293949596979899";
+
+			return pairs;
+		}
+
+		template<typename U>
+		inline int count_digits(U value, int base)
+		{
+			int n = 1;
+
+			if (base == 10)
+			{
+				for (;;)
+				{
+					if (value < 10u) return n;
+					if (value < 100u) return n + 1;
+					if (value < 1000u) return n + 2;
+					if (value < 10000u) return n + 3;
+					value /= 10000u;
+					n += 4;
+				}
+			}
+
+			for (; value >= static_cast<U>(base); value /= static_cast<U>(base))
+				n++;
+
+			return n;
+		}
+
+		// Writes the digits of value backwards, ending just before end.
+		template<typename U>
+		inline void write_digits(char *end, U value, int base)
+		{
+			if (base == 10)
+			{
+				const char *pairs = digit_pairs();
+
+				while (value >= 100u)
+				{
+					unsigned i = static_cast<unsigned>(value % 100u) * 2;
+					value /= 100u;
+					*--end = pairs[i + 1];
+					*--end = pairs[i];
+				}
+
+				if (value >= 10u)
+				{
+					unsigned i = static_cast<unsigned>(value) * 2;
+					*--end = pairs[i + 1];
+					*--end = pairs[i];
+				}
+				else
+					*--end = static_cast<char>('0' + value);
+
+				return;
+			}
+
+			static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+			do
+			{
+				*--end = digits[value % static_cast<U>(base)];
+				value /= static_cast<U>(base);
+			} while (value);
+		}
 	}
 
-	template <typename T>
-	inline T stot(const char *s, int base = 10)
+	//! Result of to_chars: end of the written characters and errc() on
+	//! success, @a last and value_too_large if the buffer is too small.
+	struct to_chars_result
 	{
-		T num = 0;
-		bool negative = false;
-		static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
-		
-		while(isspace(*s)) s++;
-			
-		if(*s == '-') {negative = true; s++;}
-		else if(*s == '+') s++;
-		
-		if(*s == '0')
+		char *ptr;
+		errc ec;
+	};
+
+	namespace details
+	{
+		template<typename T>
+		inline to_chars_result to_chars_integer(char *first, char *last, T value, int base)
+		{
+			typedef typename make_unsigned<T>::type U;
+
+			to_chars_result result = { last, value_too_large };
+			U uvalue = static_cast<U>(value);
+
+			if (is_negative<is_signed<T>::value>::apply(value))
 			{
-				s++;
-				if(*s == 'x' || *s == 'X')
-					{
-						if(base == 0) base = 16;
-						else if(base != 16) return 0;
-						s++;
-					}
-				else if(isdigit(*s))
-					{
-						if(base == 0) base = 8;
-					}
-				else if(*s == 0) return 0;
+				if (first == last)
+					return result;
+
+				*first++ = '-';
+				uvalue = U(0) - uvalue;
 			}
-		else if(*s == 0) return 0;
-		else if(base == 0) base = 10;
-		
-		for(int digit; *s; s++)
+
+			int n = count_digits(uvalue, base);
+
+			if (last - first < n)
+				return result;
+
+			write_digits(first + n, uvalue, base);
+
+			result.ptr = first + n;
+			result.ec = errc();
+
+			return result;
+		}
+	}
+
+	//! Write @a value in @a base (2 to 36, lowercase digits) to [first, last).
+	//! Reentrant, no allocation and no locale; no terminating zero is written.
+	//! Example usage:
+	//! @code
+	//! char buf[32];
+	//! to_chars_result r = to_chars(buf, buf + sizeof(buf), n);
+	//! out.append(buf, r.ptr);
+	//! @endcode
+	inline to_chars_result to_chars(char *first, char *last, int value, int base = 10)
+	{
+		return details::to_chars_integer(first, last, value, base);
+	}
+
+	inline to_chars_result to_chars(char *first, char *last, unsigned int value, int base = 10)
+	{
+		return details::to_chars_integer(first, last, value, base);
+	}
+
+	inline to_chars_result to_chars(char *first, char *last, long value, int base = 10)
+	{
+		return details::to_chars_integer(first, last, value, base);
+	}
+
+	inline to_chars_result to_chars(char *first, char *last, unsigned long value, int base = 10)
+	{
+		return details::to_chars_integer(first, last, value, base);
+	}
+
+#ifdef LLONG_MAX
+	inline to_chars_result to_chars(char *first, char *last, long long value, int base = 10)
+	{
+		return details::to_chars_integer(first, last, value, base);
+	}
+
+	inline to_chars_result to_chars(char *first, char *last, unsigned long long value, int base = 10)
+	{
+		return details::to_chars_integer(first, last, value, base);
+	}
+#endif
+
+	//! Write the shortest representation of @a value that reads back to the
+	//! same value, in fixed or scientific notation whichever is shorter (like
+	//! @c std::to_chars without format). Digits come from Grisu2: always
+	//! round-trip exact and in all but rare cases also the shortest.
+	to_chars_result to_chars(char *first, char *last, double value);
+	to_chars_result to_chars(char *first, char *last, float value);
+
+	//! Result of from_chars: end of the parsed characters and errc() on
+	//! success; invalid_argument (with @a first) if there is no number,
+	//! result_out_of_range if it doesn't fit (the value is left unchanged).
+	struct from_chars_result
+	{
+		const char *ptr;
+		errc ec;
+	};
+
+	namespace details
+	{
+		// Value of each character as a digit (0-35), 255 for non-digits.
+		inline const unsigned char* digit_values()
+		{
+			static const unsigned char values[256] =
+			{
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				  0,   1,   2,   3,   4,   5,   6,   7,   8,   9, 255, 255, 255, 255, 255, 255,
+				255,  10,  11,  12,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,
+				 25,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35, 255, 255, 255, 255, 255,
+				255,  10,  11,  12,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,
+				 25,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+				255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+			};
+
+			return values;
+		}
+
+		// Parse the digits at first as a number in base not greater than max.
+		// Runs of 8 decimal digits are converted at once (SWAR) on
+		// little-endian targets.
+		from_chars_result parse_unsigned(const char *first, const char *last, uint64_t max, uint64_t &value, int base);
+
+		template<typename T>
+		inline from_chars_result from_chars_integer(const char *first, const char *last, T &value, int base)
+		{
+			const char *p = first;
+			bool negative = false;
+
+			if (is_signed<T>::value && p != last && *p == '-')
 			{
-				const char *where = strchr(digits, tolower(*s));
-				
-				if(where == 0) break;
-				digit = where - digits;
-				if(digit >= base) break;
-				
-				num = num * base + digit;
+				negative = true;
+				p++;
 			}
 
-		if(negative) details::minus<stdex::is_signed<T>::value>::apply(num);
-		
-		return num;
+			// Two's complement: the magnitude of min() is max() + 1
+			const uint64_t max = static_cast<uint64_t>((std::numeric_limits<T>::max)()) + (negative ? 1 : 0);
+
+			uint64_t magnitude;
+			from_chars_result result = parse_unsigned(p, last, max, magnitude, base);
+
+			if (result.ec == invalid_argument)
+				result.ptr = first;
+			else if (result.ec == errc())
+			{
+				if (negative && magnitude)
+					value = static_cast<T>(-static_cast<T>(magnitude - 1) - 1);
+				else
+					value = static_cast<T>(magnitude);
+			}
+
+			return result;
+		}
+	}
+
+	//! Parse an integer in @a base (2 to 36) from [first, last): an optional
+	//! '-' for signed types, then digits; no whitespace, '+' or base prefix.
+	//! Reentrant, no allocation and no locale. Example usage:
+	//! @code
+	//! int n;
+	//! from_chars_result r = from_chars(field, field_end, n);
+	//! if (r.ec != errc())
+	//!     reject(field);
+	//! @endcode
+	inline from_chars_result from_chars(const char *first, const char *last, int &value, int base = 10)
+	{
+		return details::from_chars_integer(first, last, value, base);
+	}
+
+	inline from_chars_result from_chars(const char *first, const char *last, unsigned int &value, int base = 10)
+	{
+		return details::from_chars_integer(first, last, value, base);
+	}
+
+	inline from_chars_result from_chars(const char *first, const char *last, long &value, int base = 10)
+	{
+		return details::from_chars_integer(first, last, value, base);
+	}
+
+	inline from_chars_result from_chars(const char *first, const char *last, unsigned long &value, int base = 10)
+	{
+		return details::from_chars_integer(first, last, value, base);
+	}
+
+#ifdef LLONG_MAX
+	inline from_chars_result from_chars(const char *first, const char *last, long long &value, int base = 10)
+	{
+		return details::from_chars_integer(first, last, value, base);
+	}
+
+	inline from_chars_result from_chars(const char *first, const char *last, unsigned long long &value, int base = 10)
+	{
+		return details::from_chars_integer(first, last, value, base);
+	}
+#endif
+
+	//! Parse a floating-point number from [first, last): an optional '-',
+	//! digits with an optional '.', an optional exponent, or "inf",
+	//! "infinity", "nan" (any case). The result is correctly rounded: up to 19
+	//! significant digits are converted with the Eisel-Lemire algorithm, the
+	//! rare cases it can't decide go to @c strtod.
+	from_chars_result from_chars(const char *first, const char *last, double &value);
+	from_chars_result from_chars(const char *first, const char *last, float &value);
+
+	namespace details
+	{
+		template<bool>
+		struct stot_impl;
+
+		// Integers: like strtol, leading whitespace, a sign and a "0x" or "0"
+		// prefix when base is 0 or 16.
+		template<>
+		struct stot_impl<false>
+		{
+			template<typename T>
+			static T apply(const char *s, int base)
+			{
+				bool negative = false;
+
+				while (isspace(static_cast<unsigned char>(*s))) s++;
+
+				if (*s == '-') { negative = true; s++; }
+				else if (*s == '+') s++;
+
+				if (*s == '0' && (s[1] == 'x' || s[1] == 'X'))
+				{
+					if (base == 0) base = 16;
+					else if (base != 16) return 0;
+					s += 2;
+				}
+				else if (base == 0)
+					base = *s == '0' ? 8 : 10;
+
+				const uint64_t max = static_cast<uint64_t>((std::numeric_limits<T>::max)()) +
+					(negative && is_signed<T>::value ? 1 : 0);
+
+				uint64_t magnitude = 0; // stays 0 without digits
+				if (parse_unsigned(s, s + std::strlen(s), max, magnitude, base).ec == result_out_of_range)
+					throw std::out_of_range("stot: value out of range");
+
+				T num = static_cast<T>(magnitude);
+				if (negative)
+					num = static_cast<T>(T(0) - num);
+
+				return num;
+			}
+		};
+
+		// Floating point: leading whitespace and an optional '+'.
+		template<>
+		struct stot_impl<true>
+		{
+			template<typename T>
+			static T apply(const char *s, int)
+			{
+				while (isspace(static_cast<unsigned char>(*s))) s++;
+
+				if (*s == '+' && s[1] != '-') s++;
+
+				return static_cast<T>(parse(s, static_cast<T*>(0)));
+			}
+
+		private:
+			static double parse(const char *s, const void*)
+			{
+				double num = 0;
+				if (from_chars(s, s + std::strlen(s), num).ec == result_out_of_range)
+					throw std::out_of_range("stot: value out of range");
+
+				return num;
+			}
+
+			// from_chars stops at double precision; strtold keeps it all.
+			static long double parse(const char *s, long double*)
+			{
+				errno = 0;
+				const long double num = std::strtold(s, 0);
+
+				// Overflow, or underflow to zero
+				if (errno == ERANGE && (num == 0 || num > LDBL_MAX || num < -LDBL_MAX))
+					throw std::out_of_range("stot: value out of range");
+
+				return num;
+			}
+		};
+	}
+
+	//! Convert the number at the start of @a s to @a T; 0 if there is none.
+	//! @throws std::out_of_range if the number doesn't fit in @a T.
+	template <typename T>
+	inline T stot(const char *s, int base = 10)
+	{
+		return details::stot_impl<is_floating_point<T>::value>::template apply<T>(s, base);
 	}
 	
 	template <typename T>
@@ -111,15 +473,23 @@ namespace stdex
 	
 	inline float stof(const std::string &s)
 	{
-		return stot<float>(s.c_str());
+		const char *p = s.c_str();
+		while (isspace(static_cast<unsigned char>(*p))) p++;
+		if (*p == '+' && p[1] != '-') p++;
+
+		float num = 0;
+		if (from_chars(p, s.c_str() + s.size(), num).ec == result_out_of_range)
+			throw std::out_of_range("stof: value out of range");
+
+		return num;
 	}
 
 	inline double stod(const std::string &s)
 	{
-		return strtod(s.c_str(), nullptr);
+		return stot<double>(s.c_str());
 	}
 
-	inline double stold(const std::string &s)
+	inline long double stold(const std::string &s)
 	{
 		return stot<long double>(s.c_str());
 	}
@@ -141,19 +511,41 @@ namespace stdex
 	
 	inline std::string to_string(int value, int radix = 10)
 	{
-		static char buf[21];
-		itoa(value, buf, radix);
-		
-		return buf;
+		char buf[sizeof(value) * CHAR_BIT + 1];
+		return std::string(buf, to_chars(buf, buf + sizeof(buf), value, radix).ptr);
 	}
 
 	inline std::string to_string(unsigned int value)
 	{
-		static char buf[30];
-		sprintf(buf, "%ul", value);
+		char buf[sizeof(value) * CHAR_BIT / 3 + 1];
+		return std::string(buf, to_chars(buf, buf + sizeof(buf), value).ptr);
+	}
 
-		return buf;
+	inline std::string to_string(long value)
+	{
+		char buf[sizeof(value) * CHAR_BIT / 3 + 2];
+		return std::string(buf, to_chars(buf, buf + sizeof(buf), value).ptr);
 	}
+
+	inline std::string to_string(unsigned long value)
+	{
+		char buf[sizeof(value) * CHAR_BIT / 3 + 1];
+		return std::string(buf, to_chars(buf, buf + sizeof(buf), value).ptr);
+	}
+
+#ifdef LLONG_MAX
+	inline std::string to_string(long long value)
+	{
+		char buf[sizeof(value) * CHAR_BIT / 3 + 2];
+		return std::string(buf, to_chars(buf, buf + sizeof(buf), value).ptr);
+	}
+
+	inline std::string to_string(unsigned long long value)
+	{
+		char buf[sizeof(value) * CHAR_BIT / 3 + 1];
+		return std::string(buf, to_chars(buf, buf + sizeof(buf), value).ptr);
+	}
+#endif
 	
 	inline std::string to_string(bool value)
 	{
@@ -164,7 +556,7 @@ namespace stdex
 
 	inline std::string to_string(float value)
 	{
-		static char buf[256];
+		char buf[64]; // FLT_MAX has 39 digits
 		sprintf(buf, "%f", value);
 
 		return buf;
@@ -172,7 +564,7 @@ namespace stdex
 
 	inline std::string to_string(double value)
 	{
-		static char buf[512];
+		char buf[512]; // DBL_MAX has 309 digits
 		sprintf(buf, "%f", value);
 		
 		return buf;
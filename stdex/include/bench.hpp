@@ -0,0 +1,241 @@
+#ifndef _STDEX_BENCH_H
+#define _STDEX_BENCH_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./chrono"
+#include "./thread"
+#include "./latch"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <string>
+#include <vector>
+#include <ostream>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw()
+
+#else
+
+#define DELETED_FUNCTION
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Microbenchmark harness.
+	namespace bench
+	{
+		//! Keep the compiler from optimizing away the computation of @a value.
+		template<class _Tp>
+		inline void do_not_optimize(const _Tp &value)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__asm__ __volatile__("" : : "r"(&value) : "memory");
+#else
+			static const volatile char * volatile sink;
+			sink = reinterpret_cast<const volatile char*>(&value);
+#endif
+		}
+
+		//! Keep the compiler from caching memory across this point.
+		inline void clobber_memory()
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__asm__ __volatile__("" : : : "memory");
+#else
+			atomic_signal_fence(memory_order_seq_cst);
+#endif
+		}
+
+		//! How a benchmark is run.
+		struct options
+		{
+			unsigned warmup_runs;              //!< Untimed runs before the measured ones.
+			unsigned runs;                     //!< Measured runs; percentiles are taken over them.
+			chrono::nanoseconds min_run_time;  //!< Iterations per run are raised until a run takes this long.
+
+			options() :
+				warmup_runs(3),
+				runs(30),
+				min_run_time(chrono::milliseconds(10))
+			{}
+		};
+
+		//! Statistics of one benchmark, in nanoseconds per iteration.
+		struct result
+		{
+			std::string name;
+			unsigned threads;          //!< Threads running the function at the same time.
+			unsigned runs;
+			unsigned long iterations;  //!< Calls per run (per thread).
+			double min, mean, p50, p90, p99, max;
+		};
+
+		//! Runs benchmarks and collects their results.
+		//! Each benchmark calls a function (or function object) in a timed
+		//! loop: the iteration count is calibrated first so a run lasts at
+		//! least @c options::min_run_time, then come the warm-up runs and the
+		//! measured ones. Example usage:
+		//! @code
+		//! bench::runner r;
+		//!
+		//! r.run("mutex lock/unlock", lock_unlock());
+		//! r.run_parallel("mutex lock/unlock, 4 threads", 4, lock_unlock());
+		//!
+		//! r.write_text(std::cout);
+		//! r.write_json(json_file);
+		//! @endcode
+		class runner
+		{
+		public:
+			explicit runner(const options &opts = options()) :
+				_opts(opts)
+			{}
+
+			//! Benchmark @a func on the calling thread.
+			template<class _Function>
+			const result& run(const std::string &name, _Function func)
+			{
+				unsigned long n = 1;
+
+				while (_time(func, n) < _min_run_time_ns() && n < _max_iterations)
+					n *= 2;
+
+				for (unsigned i = 0; i < _opts.warmup_runs; ++i)
+					_time(func, n);
+
+				std::vector<double> samples;
+				samples.reserve(_opts.runs);
+
+				for (unsigned i = 0; i < _opts.runs; ++i)
+					samples.push_back(_time(func, n) / n);
+
+				return _add(name, 1, n, samples);
+			}
+
+			//! Benchmark @a func on @a threads threads started together, each
+			//! with its own copy of @a func. A run lasts until the slowest
+			//! thread is done.
+			template<class _Function>
+			const result& run_parallel(const std::string &name, unsigned threads, _Function func)
+			{
+				unsigned long n = 1;
+
+				while (_time_parallel(func, threads, n) < _min_run_time_ns() && n < _max_iterations)
+					n *= 2;
+
+				for (unsigned i = 0; i < _opts.warmup_runs; ++i)
+					_time_parallel(func, threads, n);
+
+				std::vector<double> samples;
+				samples.reserve(_opts.runs);
+
+				for (unsigned i = 0; i < _opts.runs; ++i)
+					samples.push_back(_time_parallel(func, threads, n) / n);
+
+				return _add(name, threads, n, samples);
+			}
+
+			const std::vector<result>& results() const NOEXCEPT_FUNCTION
+			{
+				return _results;
+			}
+
+			//! Write the results as a table.
+			void write_text(std::ostream &out) const;
+
+			//! Write the results as JSON:
+			//! <tt>{"benchmarks": [{"name": ..., "threads": ..., "runs": ...,
+			//! "iterations": ..., "ns_per_iteration": {"min": ..., "mean": ...,
+			//! "p50": ..., "p90": ..., "p99": ..., "max": ...}}, ...]}</tt>
+			void write_json(std::ostream &out) const;
+
+		private:
+			static const unsigned long _max_iterations = 1UL << 30;
+
+			options _opts;
+			std::vector<result> _results;
+
+			double _min_run_time_ns() const
+			{
+				return static_cast<double>(_opts.min_run_time.count());
+			}
+
+			static double _elapsed_ns(const chrono::steady_clock::time_point &start)
+			{
+				return static_cast<double>(
+					chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+			}
+
+			template<class _Function>
+			static double _time(_Function &func, unsigned long n)
+			{
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+				for (unsigned long i = 0; i < n; ++i)
+					func();
+
+				return _elapsed_ns(start);
+			}
+
+			template<class _Function>
+			struct _parallel_context
+			{
+				_Function func;
+				unsigned long n;
+				latch *start;
+				double elapsed_ns;
+
+				static void proxy(void *arg)
+				{
+					_parallel_context &ctx = *static_cast<_parallel_context*>(arg);
+
+					ctx.start->arrive_and_wait();
+					ctx.elapsed_ns = _time(ctx.func, ctx.n);
+				}
+			};
+
+			template<class _Function>
+			static double _time_parallel(const _Function &func, unsigned threads, unsigned long n)
+			{
+				latch start(threads);
+				_parallel_context<_Function> proto = { func, n, &start, 0 };
+				std::vector<_parallel_context<_Function> > contexts(threads, proto);
+				std::vector<thread*> workers;
+
+				for (unsigned i = 0; i < threads; ++i)
+					workers.push_back(new thread(&_parallel_context<_Function>::proxy, &contexts[i]));
+
+				double elapsed_ns = 0;
+
+				for (unsigned i = 0; i < threads; ++i)
+				{
+					workers[i]->join();
+					delete workers[i];
+
+					if (contexts[i].elapsed_ns > elapsed_ns)
+						elapsed_ns = contexts[i].elapsed_ns;
+				}
+
+				return elapsed_ns;
+			}
+
+			const result& _add(const std::string &name, unsigned threads, unsigned long n, std::vector<double> &samples);
+
+			runner(const runner&) DELETED_FUNCTION;
+			runner& operator=(const runner&) DELETED_FUNCTION;
+		};
+	} // namespace bench
+} // namespace stdex
+
+#endif // _STDEX_BENCH_H
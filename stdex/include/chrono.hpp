@@ -40,10 +40,10 @@ namespace stdex
 
 		template<typename _Clock, typename _Dur = typename _Clock::duration>
 		struct time_point;
-	}
 
-	namespace
-	{
+		// Common type of the arithmetic types used as rep, which are all
+		// converted to intmax_t. Kept in chrono so it doesn't clash with the
+		// common_type of type_traits.
 		template<typename _Tp>
 		struct _success_type
 		{
@@ -59,37 +59,71 @@ namespace stdex
 			typedef intmax_t type;
 		};
 
-	}
+		// specialization of common_type (for duration)
+		template<class _Rep1, class _Period1, class _Rep2, class _Period2>
+		struct common_type<duration<_Rep1, _Period1>,
+			duration<_Rep2, _Period2> >
+		{
+		private:
+			typedef _gcd<_Period1::num, _Period2::num> 	_gcd_num;
+			typedef _gcd<_Period1::den, _Period2::den> 	_gcd_den;
+			typedef typename common_type<_Rep1, _Rep2>::type		_cr;
+			typedef ratio<_gcd_num::value,
+				(_Period1::den / _gcd_den::value) * _Period2::den> _r;
 
-	template<class _Rep1, class _Period1, class _Rep2, class _Period2>
-	struct common_type<chrono::duration<_Rep1, _Period1>,
-		chrono::duration<_Rep2, _Period2> >
-	{
-	private:
-		typedef _gcd<_Period1::num, _Period2::num> 	_gcd_num;
-		typedef _gcd<_Period1::den, _Period2::den> 	_gcd_den;
-		typedef typename common_type<_Rep1, _Rep2>::type		_cr;
-		typedef ratio<_gcd_num::value,
-			(_Period1::den / _gcd_den::value) * _Period2::den> _r;
-
-	public:
-		typedef chrono::duration<_cr, _r> 			type;
-	};
-
-	// specialization of common_type (for time_point)
-	template<class _Clock, class _Dur1, class _Dur2>
-	struct common_type<chrono::time_point<_Clock, _Dur1>,
-		chrono::time_point<_Clock, _Dur2> >
-	{
-	private:
-		typedef typename common_type<_Dur1, _Dur2>::type 		_ct;
+		public:
+			typedef duration<_cr, _r> 			type;
+		};
 
-	public:
-		typedef chrono::time_point<_Clock, _ct> 			type;
-	};
+		// specialization of common_type (for time_point)
+		template<class _Clock, class _Dur1, class _Dur2>
+		struct common_type<time_point<_Clock, _Dur1>,
+			time_point<_Clock, _Dur2> >
+		{
+		private:
+			typedef typename common_type<_Dur1, _Dur2>::type 		_ct;
+
+		public:
+			typedef time_point<_Clock, _ct> 			type;
+		};
+
+		// v * _Num / _Den for the general case of duration_cast.
+		template<class _CR, intmax_t _Num, intmax_t _Den,
+			bool _SplitFits = (_Den <= __INTMAX_MAX / _Num)>
+		struct _duration_mul_div
+		{
+			static _CR _apply(_CR v)
+			{
+				return v * static_cast<_CR>(_Num) / static_cast<_CR>(_Den);
+			}
+		};
+
+		// Integers: with v = q * _Den + r, v * _Num / _Den = q * _Num + r * _Num / _Den
+		// where |r * _Num| < _Den * _Num fits, so the product only overflows
+		// if the result does. Division and remainder by the constant _Den
+		// compile to multiplications and shifts.
+		template<intmax_t _Num, intmax_t _Den>
+		struct _duration_mul_div<intmax_t, _Num, _Den, true>
+		{
+			static intmax_t _apply(intmax_t v)
+			{
+				return (v / _Den) * _Num + (v % _Den) * _Num / _Den;
+			}
+		};
+
+#ifdef __SIZEOF_INT128__
+		// _Den * _Num itself overflows: 128-bit intermediate.
+		template<intmax_t _Num, intmax_t _Den>
+		struct _duration_mul_div<intmax_t, _Num, _Den, false>
+		{
+			static intmax_t _apply(intmax_t v)
+			{
+				__extension__ typedef __int128 _wide;
+				return static_cast<intmax_t>(static_cast<_wide>(v) * _Num / _Den);
+			}
+		};
+#endif
 
-	namespace chrono
-	{
 		// Primary template for duration_cast impl.
 		template<class _ToDur, class _CF, class _CR,
 			bool _NumIsOne = false, bool _DenIsOne = false>
@@ -99,9 +133,8 @@ namespace stdex
 			static _ToDur _cast(const duration<_Rep, _Period> &d)
 			{
 				typedef typename _ToDur::rep			_to_rep;
-				return _ToDur(static_cast<_to_rep>(static_cast<_CR>(d.count())
-					* static_cast<_CR>(_CF::num)
-					/ static_cast<_CR>(_CF::den)));
+				return _ToDur(static_cast<_to_rep>(
+					_duration_mul_div<_CR, _CF::num, _CF::den>::_apply(static_cast<_CR>(d.count()))));
 			}
 		};
 
@@ -243,38 +276,38 @@ namespace stdex
 			// since we have no static_assert in pre-C++11 we just compile-time assert this way:
 			struct chrono_asserts
 			{
-				template<bool>
+				template<bool _Cond, class _Dummy = void>
 				struct rep_cannot_be_a_duration_assert; // if you are there means 1st template param _Rep in duration class is duration type
 
-				template<>
-				struct rep_cannot_be_a_duration_assert<true>
+				template<class _Dummy>
+				struct rep_cannot_be_a_duration_assert<true, _Dummy>
 				{
 					typedef bool is_ok;
 				};
 
-				template<bool>
+				template<bool _Cond, class _Dummy = void>
 				struct period_must_be_a_specialization_of_ratio_assert; // if you are there means 2nd template param _Period in duration class is not a specialization of ratio class
 
-				template<>
-				struct period_must_be_a_specialization_of_ratio_assert<true>
+				template<class _Dummy>
+				struct period_must_be_a_specialization_of_ratio_assert<true, _Dummy>
 				{
 					typedef bool is_ok;
 				};
 
-				template<bool>
+				template<bool _Cond, class _Dummy = void>
 				struct period_must_be_positive_assert; // if you are there means 2nd template param _Period in duration class is ratio of negative
 
-				template<>
-				struct period_must_be_positive_assert<true>
+				template<class _Dummy>
+				struct period_must_be_positive_assert<true, _Dummy>
 				{
 					typedef bool is_ok;
 				};
 
-				template<bool>
+				template<bool _Cond, class _Dummy = void>
 				struct a_clocks_minimum_duration_cannot_be_less_than_its_epoch_assert; // if you are there means that what it says
 
-				template<>
-				struct a_clocks_minimum_duration_cannot_be_less_than_its_epoch_assert<true>
+				template<class _Dummy>
+				struct a_clocks_minimum_duration_cannot_be_less_than_its_epoch_assert<true, _Dummy>
 				{
 					typedef bool is_ok;
 				};
@@ -404,7 +437,7 @@ namespace stdex
 				static const duration max()
 			#endif
 			{
-				return duration_values<_Rep>::(max)();
+				return (duration_values<_Rep>::max)();
 			}
 
 			#ifdef min
@@ -413,7 +446,7 @@ namespace stdex
 				static const duration min()
 			#endif
 			{
-				return duration_values<_Rep>::(min)();
+				return (duration_values<_Rep>::min)();
 			}
 		};
 
@@ -647,6 +680,88 @@ namespace stdex
 			return _time_point(duration_cast<_ToDur>(t.time_since_epoch()));
 		}
 
+		//! Greatest @a _ToDur not greater than @a d.
+		template<class _ToDur, class _Rep, class _Period>
+		typename _enable_if_is_duration<_ToDur>::type
+		floor(const duration<_Rep, _Period> &d)
+		{
+			_ToDur t = duration_cast<_ToDur>(d);
+
+			if (t > d)
+				--t;
+
+			return t;
+		}
+
+		//! Least @a _ToDur not less than @a d.
+		template<class _ToDur, class _Rep, class _Period>
+		typename _enable_if_is_duration<_ToDur>::type
+		ceil(const duration<_Rep, _Period> &d)
+		{
+			_ToDur t = duration_cast<_ToDur>(d);
+
+			if (t < d)
+				++t;
+
+			return t;
+		}
+
+		//! @a _ToDur nearest to @a d, ties to even.
+		template<class _ToDur, class _Rep, class _Period>
+		typename _enable_if_is_duration<_ToDur>::type
+		round(const duration<_Rep, _Period> &d)
+		{
+			_ToDur t0 = floor<_ToDur>(d);
+			_ToDur t1 = t0;
+			++t1;
+
+			const typename common_type<duration<_Rep, _Period>, _ToDur>::type
+				diff0 = d - t0,
+				diff1 = t1 - d;
+
+			if (diff0 == diff1)
+				return (t0.count() & 1) ? t1 : t0;
+
+			return diff0 < diff1 ? t0 : t1;
+		}
+
+		//! Absolute value of @a d.
+		template<class _Rep, class _Period>
+		duration<_Rep, _Period> abs(const duration<_Rep, _Period> &d)
+		{
+			return d < duration<_Rep, _Period>::zero() ? -d : d;
+		}
+
+		//! Time point of @a t rounded down to a multiple of @a _ToDur.
+		template<class _ToDur, class _Clock, class _Dur>
+		inline typename _time_point_enable_if_is_duration<_ToDur, _Clock>::type
+		floor(const time_point<_Clock, _Dur> &t)
+		{
+			typedef time_point<_Clock, _ToDur> 			_time_point;
+
+			return _time_point(floor<_ToDur>(t.time_since_epoch()));
+		}
+
+		//! Time point of @a t rounded up to a multiple of @a _ToDur.
+		template<class _ToDur, class _Clock, class _Dur>
+		inline typename _time_point_enable_if_is_duration<_ToDur, _Clock>::type
+		ceil(const time_point<_Clock, _Dur> &t)
+		{
+			typedef time_point<_Clock, _ToDur> 			_time_point;
+
+			return _time_point(ceil<_ToDur>(t.time_since_epoch()));
+		}
+
+		//! Time point of @a t rounded to the nearest multiple of @a _ToDur.
+		template<class _ToDur, class _Clock, class _Dur>
+		inline typename _time_point_enable_if_is_duration<_ToDur, _Clock>::type
+		round(const time_point<_Clock, _Dur> &t)
+		{
+			typedef time_point<_Clock, _ToDur> 			_time_point;
+
+			return _time_point(round<_ToDur>(t.time_since_epoch()));
+		}
+
 		template<class _Clock, class _Dur1,
 			class _Rep2, class _Period2>
 			 time_point<_Clock,
@@ -792,6 +907,29 @@ namespace stdex
 				now() NOEXCEPT_FUNCTION;
 		};
 
+		/**
+		*  @brief Monotonic clock read from the CPU time stamp counter
+		*
+		*  Opt-in clock for hot paths: now() reads the invariant TSC and scales
+		*  it by a factor calibrated against steady_clock on the first call
+		*  (which blocks for about 10 milliseconds), so no clock_gettime call is
+		*  made afterwards. The epoch is the one of steady_clock, but the clocks
+		*  may drift apart by a few microseconds per second. Where no invariant
+		*  TSC is available now() falls back to steady_clock.
+		*/
+		struct fast_steady_clock
+		{
+			typedef chrono::nanoseconds 						duration;
+			typedef fast_steady_clock::duration::rep	  						rep;
+			typedef fast_steady_clock::duration::period	  					period;
+			typedef chrono::time_point<fast_steady_clock, duration> 	time_point;
+
+			static const bool is_steady;
+
+			static time_point
+				now() NOEXCEPT_FUNCTION;
+		};
+
 
 		/**
 		*  @brief Highest-resolution clock
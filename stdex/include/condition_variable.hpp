@@ -14,6 +14,13 @@
 
 // std includes
 #include <memory>
+#include <ctime> // for CLOCK_MONOTONIC
+
+// Timed waits are measured on CLOCK_MONOTONIC where the clock of a
+// condition variable can be selected (pthread_condattr_setclock).
+#if defined(CLOCK_MONOTONIC) && !defined(__APPLE__) && !defined(_WIN32)
+	#define _STDEX_CONDVAR_MONOTONIC
+#endif
 
 
 namespace stdex
@@ -46,9 +53,17 @@ namespace stdex
 	//!   cond.notify_all();
 	//! }
 	//! @endcode
+	//! @note Timeouts are measured on the steady clock where the platform
+	//! allows it, so changes of the system time don't shorten or lengthen
+	//! @c wait_for(). Deadlines on other clocks are converted once when the
+	//! wait starts.
 	class condition_variable 
 	{
+#ifdef _STDEX_CONDVAR_MONOTONIC
+		typedef chrono::steady_clock clock_t;
+#else
 		typedef chrono::system_clock clock_t;
+#endif
 
 	public:
 		typedef pthread_cond_t* native_handle_type;
@@ -56,7 +71,15 @@ namespace stdex
 		//! Constructor.
 		condition_variable() NOEXCEPT_FUNCTION
 		{
+#ifdef _STDEX_CONDVAR_MONOTONIC
+			pthread_condattr_t attr;
+			pthread_condattr_init(&attr);
+			pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+			pthread_cond_init(&_condition_handle, &attr);
+			pthread_condattr_destroy(&attr);
+#else
 			pthread_cond_init(&_condition_handle, NULL);
+#endif
 		}
 
 		//! Destructor.
@@ -101,7 +124,12 @@ namespace stdex
 			const typename _Clock::time_point c_entry = _Clock::now();
 			const clock_t::time_point s_entry = clock_t::now();
 
-			return wait_until_impl(lock, (s_entry + atime - c_entry));
+			if (wait_until_impl(lock, s_entry + (atime - c_entry)) == no_timeout)
+				return no_timeout;
+
+			// the clocks may have drifted apart: only _Clock can tell, the
+			// caller waits again if it was early
+			return (_Clock::now() < atime ? no_timeout : timeout);
 		}
 
 		template<class _Clock, class _Duration, class _Predicate>
@@ -158,17 +186,11 @@ namespace stdex
 			if (!lock.owns_lock())
 				std::terminate();
 
-			chrono::time_point<clock_t, chrono::seconds> s = chrono::time_point_cast<chrono::seconds>(atime);
-			chrono::nanoseconds ns = chrono::duration_cast<chrono::nanoseconds>(atime - s);
-
-			timespec ts;
-			ts.tv_sec = static_cast<stdex::time_t>(s.time_since_epoch().count());
-			ts.tv_nsec = static_cast<long>(ns.count());
+			timespec ts = detail::_to_timespec(atime);
 
 			int res = pthread_cond_timedwait(&_condition_handle, lock.mutex()->native_handle(), &ts);
 
-			return (clock_t::now() < atime
-				? no_timeout : timeout);
+			return (res == ETIMEDOUT ? timeout : no_timeout);
 		}
 
 		pthread_cond_t _condition_handle;
@@ -176,6 +198,122 @@ namespace stdex
 		condition_variable(const condition_variable&) DELETED_FUNCTION;
 		condition_variable& operator=(const condition_variable&) DELETED_FUNCTION;
 	};
+
+	//! Condition variable for any lockable.
+	//! Like condition_variable, but works with any type providing @c lock()
+	//! and @c unlock() (recursive_mutex, adaptive_mutex, shared_lock, a
+	//! unique_lock of any mutex...). Example usage:
+	//! @code
+	//! recursive_mutex m;
+	//! condition_variable_any cond;
+	//!
+	//! unique_lock<recursive_mutex> lock(m);
+	//! while (!ready)
+	//!   cond.wait(lock);
+	//! @endcode
+	//! @note Waits go through an internal mutex and a condition_variable, so
+	//! prefer condition_variable with unique_lock<mutex>.
+	class condition_variable_any
+	{
+	public:
+		//! Constructor.
+		condition_variable_any()
+		{}
+
+		//! Destructor.
+		~condition_variable_any()
+		{}
+
+		//! Notify one thread that is waiting for the condition.
+		//! @see condition_variable::notify_one
+		void notify_one() NOEXCEPT_FUNCTION
+		{
+			// a waiter has released its lock only once it holds _lock
+			lock_guard<mutex> guard(_lock);
+			_cond.notify_one();
+		}
+
+		//! Notify all threads that are waiting for the condition.
+		//! @see condition_variable::notify_all
+		void notify_all() NOEXCEPT_FUNCTION
+		{
+			lock_guard<mutex> guard(_lock);
+			_cond.notify_all();
+		}
+
+		//! Wait for the condition.
+		//! @a lock is unlocked while waiting and locked again before return.
+		template<class _Lock>
+		void wait(_Lock &lock)
+		{
+			_relock<_Lock> relock(lock);
+			unique_lock<mutex> internal(_lock);
+
+			lock.unlock();
+			relock.armed = true;
+			_cond.wait(internal);
+		}
+
+		template<class _Lock, class _Predicate>
+		void wait(_Lock &lock, _Predicate p)
+		{
+			while (!p())
+				wait(lock);
+		}
+
+		template<class _Lock, class _Clock, class _Duration>
+		cv_status wait_until(_Lock &lock, const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			_relock<_Lock> relock(lock);
+			unique_lock<mutex> internal(_lock);
+
+			lock.unlock();
+			relock.armed = true;
+			return _cond.wait_until(internal, atime);
+		}
+
+		template<class _Lock, class _Clock, class _Duration, class _Predicate>
+		bool wait_until(_Lock &lock, const chrono::time_point<_Clock, _Duration> &atime, _Predicate p)
+		{
+			while (!p())
+				if (wait_until(lock, atime) == timeout)
+					return p();
+			return true;
+		}
+
+		template<class _Lock, class _Rep, class _Period>
+		cv_status wait_for(_Lock &lock, const chrono::duration<_Rep, _Period> &rtime)
+		{
+			return wait_until(lock, chrono::steady_clock::now() + rtime);
+		}
+
+		template<class _Lock, class _Rep, class _Period, class _Predicate>
+		bool wait_for(_Lock &lock, const chrono::duration<_Rep, _Period> &rtime, _Predicate p)
+		{
+			return wait_until(lock, chrono::steady_clock::now() + rtime, p);
+		}
+
+	private:
+		// Locks the user lock again when the wait ends (also by an exception).
+		// Declared before the lock of the internal mutex so that one is
+		// released first: relocking while holding it could deadlock with a
+		// notifier that holds the user lock.
+		template<class _Lock>
+		struct _relock
+		{
+			explicit _relock(_Lock &lock_) :lock(lock_), armed(false) {}
+			~_relock() { if (armed) lock.lock(); }
+
+			_Lock &lock;
+			bool armed; // set once the user lock was released
+		};
+
+		mutex _lock;
+		condition_variable _cond;
+
+		condition_variable_any(const condition_variable_any&) DELETED_FUNCTION;
+		condition_variable_any& operator=(const condition_variable_any&) DELETED_FUNCTION;
+	};
 } // namespace stdex
 
 #endif // _STDEX_CONDITION_VARIABLE_H
\ No newline at end of file
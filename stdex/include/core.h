@@ -17,7 +17,7 @@
 
 //#ifndef _STDEX_NATIVE_CPP11_SUPPORT
 
-	#if (!defined(_MSC_VER) || _MSC_VER < 1800)
+	#if (!defined(_STDEX_NATIVE_CPP11_SUPPORT) && (!defined(_MSC_VER) || _MSC_VER < 1800))
 
 		#define _STDEX_IMPLEMENTS_NULLPTR_SUPPORT
 
@@ -51,6 +51,15 @@
 
 #define forever for(;;)
 
+// Storage class for POD variables with static storage duration that should
+// have one instance per thread. Left undefined when the compiler has no such
+// extension so the code could fall back to pthread keys.
+#if defined(_MSC_VER) || defined(__BORLANDC__)
+	#define _STDEX_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+	#define _STDEX_THREAD_LOCAL __thread
+#endif
+
 
 
 #ifdef _STDEX_NATIVE_CPP11_SUPPORT
@@ -0,0 +1,1188 @@
+#ifndef _STDEX_FUTURE_H
+#define _STDEX_FUTURE_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./condition_variable"
+#include "./chrono"
+#include "./system_error"
+#include "./atomic"
+
+// POSIX includes
+#include <pthread>
+
+// std includes
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <new>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	// C++ 11 scoped enumerations are emulated with enumerations nested in
+	// structures so they are written the same way: future_status::ready
+
+	//! Error codes reported by future_error.
+	struct future_errc
+	{
+		enum type
+		{
+			broken_promise = 1,
+			future_already_retrieved,
+			promise_already_satisfied,
+			no_state
+		};
+	};
+
+	//! Result of the timed waits of future and shared_future.
+	struct future_status
+	{
+		enum type
+		{
+			ready,
+			timeout,
+			deferred
+		};
+	};
+
+	//! Launch policies for async.
+	struct launch
+	{
+		enum type
+		{
+			async = 1,   //!< Run on a new thread.
+			deferred = 2 //!< Run in the first thread that waits for the result.
+		};
+	};
+
+	//! Exception thrown on misuse of futures and promises.
+	class future_error:
+		public std::logic_error
+	{
+	public:
+		explicit future_error(future_errc::type ec):
+			std::logic_error(_message(ec)),
+			_code(ec)
+		{}
+
+		future_errc::type code() const NOEXCEPT_FUNCTION
+		{
+			return _code;
+		}
+
+	private:
+		future_errc::type _code;
+
+		static const char* _message(future_errc::type ec)
+		{
+			switch (ec)
+			{
+			case future_errc::broken_promise:
+				return "broken promise";
+			case future_errc::future_already_retrieved:
+				return "future already retrieved";
+			case future_errc::promise_already_satisfied:
+				return "promise already satisfied";
+			case future_errc::no_state:
+				return "no associated state";
+			}
+			return "unknown future error";
+		}
+	};
+
+	template<class _Tp> class future;
+	template<class _Tp> class shared_future;
+
+	namespace detail
+	{
+		// Storage suitably aligned for any type of at most _Size bytes.
+		template<std::size_t _Size>
+		union _aligned_storage
+		{
+			char data[_Size];
+			long double align_ld;
+			double align_d;
+			long align_l;
+			void *align_p;
+			void(*align_f)();
+		};
+
+		//! Shared state of a future and the provider of its result (promise,
+		//! packaged_task or async). It is reference counted by all of them and
+		//! holds the result and everything needed to wait for it in one
+		//! allocation.
+		class future_state_base
+		{
+		public:
+			future_state_base():
+				_refs(1),
+				_ready(false),
+				_satisfied(false),
+				_invoked(false),
+				_retrieved(false),
+				_deferred(false),
+				_deferred_started(false),
+				_error(0)
+			{}
+
+			virtual ~future_state_base()
+			{}
+
+			void add_ref() NOEXCEPT_FUNCTION
+			{
+				_refs.fetch_add(1, memory_order_relaxed);
+			}
+
+			void release() NOEXCEPT_FUNCTION
+			{
+				if (_refs.fetch_sub(1, memory_order_acq_rel) == 1)
+					delete this;
+			}
+
+			// Marks the future as retrieved by the provider (only one allowed).
+			void retrieve()
+			{
+				lock_guard<mutex> guard(_lock);
+
+				if (_retrieved)
+					throw future_error(future_errc::future_already_retrieved);
+				_retrieved = true;
+			}
+
+			void wait()
+			{
+				_run_deferred_once();
+
+				unique_lock<mutex> lock(_lock);
+
+				while (!_ready)
+					_cond.wait(lock);
+			}
+
+			template<class _Clock, class _Duration>
+			future_status::type wait_until(const chrono::time_point<_Clock, _Duration> &atime)
+			{
+				unique_lock<mutex> lock(_lock);
+
+				if (_deferred && !_deferred_started)
+					return future_status::deferred;
+
+				while (!_ready)
+				{
+					if (_cond.wait_until(lock, atime) == timeout)
+						return _ready ? future_status::ready : future_status::timeout;
+				}
+
+				return future_status::ready;
+			}
+
+			void set_exception(const std::exception &e)
+			{
+				lock_guard<mutex> guard(_lock);
+
+				_satisfy();
+				_store_exception(e);
+				_make_ready();
+			}
+
+			void set_exception(const char *what)
+			{
+				lock_guard<mutex> guard(_lock);
+
+				_satisfy();
+				_error = _exception;
+				_what = what;
+				_make_ready();
+			}
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+			void set_exception(std::exception_ptr p)
+			{
+				lock_guard<mutex> guard(_lock);
+
+				_satisfy();
+				_error = _exception_ptr;
+				_stored_exception = p;
+				_make_ready();
+			}
+#endif
+
+			// Called by a provider that goes away without a result.
+			void abandon()
+			{
+				lock_guard<mutex> guard(_lock);
+
+				if (_satisfied)
+					return;
+
+				_satisfied = true;
+				_error = _broken_promise;
+				_make_ready();
+			}
+
+			void set_deferred() NOEXCEPT_FUNCTION
+			{
+				_deferred = true;
+			}
+
+			// Runs the deferred function, if any. Meant for the thread the
+			// function was given to by async.
+			virtual void run()
+			{}
+
+		protected:
+			enum
+			{
+				_exception = 1,  // rethrown as std::runtime_error(_what)
+				_future_error,   // rethrown as future_error(_future_code)
+				_system_error,   // rethrown as system_error(_system_code)
+				_exception_ptr,  // rethrown from _stored_exception
+				_broken_promise
+			};
+
+			mutex _lock;
+			condition_variable _cond;
+			atomic<long> _refs;
+			bool _ready;
+			bool _satisfied;
+			bool _invoked;
+			bool _retrieved;
+			bool _deferred;
+			bool _deferred_started;
+			int _error;
+			std::string _what;
+			future_errc::type _future_code;
+			error_code _system_code;
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+			std::exception_ptr _stored_exception;
+#endif
+
+			// Called with _lock held.
+			void _check_unsatisfied() const
+			{
+				if (_satisfied)
+					throw future_error(future_errc::promise_already_satisfied);
+			}
+
+			// Called with _lock held.
+			void _satisfy()
+			{
+				_check_unsatisfied();
+				_satisfied = true;
+			}
+
+			// Called by a task before it invokes its function, which must run
+			// only once.
+			void _start_invocation()
+			{
+				lock_guard<mutex> guard(_lock);
+
+				if (_invoked)
+					throw future_error(future_errc::promise_already_satisfied);
+				_check_unsatisfied();
+				_invoked = true;
+			}
+
+			// Called with _lock held. Without exception_ptr only the type of
+			// future_error and system_error survives, with their code; any
+			// other exception comes back as std::runtime_error.
+			void _store_exception(const std::exception &e)
+			{
+				_what = e.what();
+
+				if (const future_error *fe = dynamic_cast<const future_error*>(&e))
+				{
+					_error = _future_error;
+					_future_code = fe->code();
+				}
+				else if (const system_error *se = dynamic_cast<const system_error*>(&e))
+				{
+					_error = _system_error;
+					_system_code = se->code();
+				}
+				else
+					_error = _exception;
+			}
+
+			// Called with _lock held.
+			void _make_ready()
+			{
+				_ready = true;
+				_cond.notify_all();
+			}
+
+			// Waits and throws the stored error, if any.
+			void _wait_and_check()
+			{
+				wait();
+
+				switch (_error)
+				{
+				case _broken_promise:
+					throw future_error(future_errc::broken_promise);
+				case _future_error:
+					throw future_error(_future_code);
+				case _system_error:
+					throw _rebuild_system_error(_system_code, _what);
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+				case _exception_ptr:
+					std::rethrow_exception(_stored_exception);
+#endif
+				case _exception:
+					throw std::runtime_error(_what);
+				}
+			}
+
+			// The system_error with code ec that has what() as its message;
+			// what usually ends with the message of ec, which the constructor
+			// appends again.
+			static system_error _rebuild_system_error(const error_code &ec, const std::string &what)
+			{
+				const std::string message = ec.message();
+
+				if (what == message)
+					return system_error(ec);
+
+				const std::string suffix = ": " + message;
+
+				if (what.size() > suffix.size() && what.compare(what.size() - suffix.size(), suffix.size(), suffix) == 0)
+					return system_error(ec, what.substr(0, what.size() - suffix.size()));
+
+				return system_error(ec, what);
+			}
+
+		private:
+			void _run_deferred_once()
+			{
+				if (!_deferred)
+					return;
+
+				{
+					lock_guard<mutex> guard(_lock);
+
+					if (_deferred_started)
+						return;
+					_deferred_started = true;
+				}
+
+				run();
+			}
+
+			future_state_base(const future_state_base&) DELETED_FUNCTION;
+			future_state_base& operator=(const future_state_base&) DELETED_FUNCTION;
+		};
+
+		template<class _Tp>
+		class future_state:
+			public future_state_base
+		{
+		public:
+			future_state()
+			{}
+
+			~future_state()
+			{
+				if (_ready && !_error)
+					_value()->~_Tp();
+			}
+
+			void set_value(const _Tp &value)
+			{
+				lock_guard<mutex> guard(_lock);
+
+				// A throwing copy constructor leaves the state unsatisfied
+				_check_unsatisfied();
+				new(_storage.data) _Tp(value);
+				_satisfied = true;
+				_make_ready();
+			}
+
+			_Tp& get()
+			{
+				_wait_and_check();
+				return *_value();
+			}
+
+		private:
+			_aligned_storage<sizeof(_Tp)> _storage;
+
+			_Tp* _value()
+			{
+				return reinterpret_cast<_Tp*>(_storage.data);
+			}
+		};
+
+		template<>
+		class future_state<void>:
+			public future_state_base
+		{
+		public:
+			void set_value()
+			{
+				lock_guard<mutex> guard(_lock);
+
+				_satisfy();
+				_make_ready();
+			}
+
+			void get()
+			{
+				_wait_and_check();
+			}
+		};
+
+		// Stores the result of a call to the state, the void result included.
+		template<class _Res>
+		struct _invoke_and_set
+		{
+			template<class _Fn>
+			static void call(future_state<_Res> &state, _Fn &f)
+			{
+				state.set_value(f());
+			}
+
+			template<class _Fn, class _Arg>
+			static void call(future_state<_Res> &state, _Fn &f, _Arg arg)
+			{
+				state.set_value(f(arg));
+			}
+		};
+
+		template<>
+		struct _invoke_and_set<void>
+		{
+			template<class _Fn>
+			static void call(future_state<void> &state, _Fn &f)
+			{
+				f();
+				state.set_value();
+			}
+
+			template<class _Fn, class _Arg>
+			static void call(future_state<void> &state, _Fn &f, _Arg arg)
+			{
+				f(arg);
+				state.set_value();
+			}
+		};
+
+		//! Shared state that also holds the function computing the result.
+		template<class _Res, class _Fn>
+		class task_state:
+			public future_state<_Res>
+		{
+		public:
+			explicit task_state(const _Fn &f):
+				_f(f)
+			{}
+
+			virtual void run()
+			{
+				this->_start_invocation();
+
+				try
+				{
+					_invoke_and_set<_Res>::call(*this, _f);
+				}
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+				catch (...)
+				{
+					this->set_exception(std::current_exception());
+				}
+#else
+				catch (const std::exception &e)
+				{
+					this->set_exception(e);
+				}
+				catch (...)
+				{
+					this->set_exception("unknown exception");
+				}
+#endif
+			}
+
+		private:
+			_Fn _f;
+		};
+
+		// Common part of future and shared_future: a counted reference to the state.
+		template<class _Tp>
+		class basic_future
+		{
+		public:
+			//! Check if the future refers to a shared state.
+			bool valid() const NOEXCEPT_FUNCTION
+			{
+				return _state != 0;
+			}
+
+			//! Block until the result is ready.
+			void wait() const
+			{
+				_check_state();
+				_state->wait();
+			}
+
+			//! Block until the result is ready or @a rtime has passed.
+			//! @return @c future_status::deferred without waiting if the result
+			//! is computed by a deferred function that has not been started.
+			template<class _Rep, class _Period>
+			future_status::type wait_for(const chrono::duration<_Rep, _Period> &rtime) const
+			{
+				return wait_until(chrono::steady_clock::now() + rtime);
+			}
+
+			//! Block until the result is ready or @a atime is reached.
+			template<class _Clock, class _Duration>
+			future_status::type wait_until(const chrono::time_point<_Clock, _Duration> &atime) const
+			{
+				_check_state();
+				return _state->wait_until(atime);
+			}
+
+		protected:
+			future_state<_Tp> *_state;
+
+			basic_future() NOEXCEPT_FUNCTION:
+				_state(0)
+			{}
+
+			// Takes a new reference to the state.
+			explicit basic_future(future_state<_Tp> *state) NOEXCEPT_FUNCTION:
+				_state(state)
+			{
+				if (_state)
+					_state->add_ref();
+			}
+
+			basic_future(const basic_future &other) NOEXCEPT_FUNCTION:
+				_state(other._state)
+			{
+				if (_state)
+					_state->add_ref();
+			}
+
+			~basic_future()
+			{
+				_reset();
+			}
+
+			basic_future& operator=(const basic_future &other) NOEXCEPT_FUNCTION
+			{
+				if (other._state)
+					other._state->add_ref();
+				_reset();
+				_state = other._state;
+				return *this;
+			}
+
+			void _reset() NOEXCEPT_FUNCTION
+			{
+				if (_state)
+					_state->release();
+				_state = 0;
+			}
+
+			void _check_state() const
+			{
+				if (!_state)
+					throw future_error(future_errc::no_state);
+			}
+		};
+	}
+
+	//! Future class.
+	//! Provides access to the result of an asynchronous operation started by
+	//! async, a packaged_task or set through a promise.
+	//! @note Without move semantics copies of a future refer to the same
+	//! shared state. @c get() releases the state of the future it is called on.
+	template<class _Tp>
+	class future:
+		public detail::basic_future<_Tp>
+	{
+		typedef detail::basic_future<_Tp> _base;
+
+	public:
+		future() NOEXCEPT_FUNCTION
+		{}
+
+		explicit future(detail::future_state<_Tp> *state) NOEXCEPT_FUNCTION:
+			_base(state)
+		{}
+
+		//! Wait for the result and return it.
+		//! @throws future_error with @c future_errc::broken_promise if the
+		//! provider was destroyed without a result, or the exception the
+		//! provider stored (see promise::set_exception).
+		_Tp get()
+		{
+			this->_check_state();
+
+			detail::future_state<_Tp> *state = this->_state;
+			state->add_ref();
+			this->_reset();
+
+			try
+			{
+				_Tp result = state->get();
+				state->release();
+				return result;
+			}
+			catch (...)
+			{
+				state->release();
+				throw;
+			}
+		}
+
+		//! Transfer the shared state to a shared_future.
+		shared_future<_Tp> share()
+		{
+			shared_future<_Tp> result(this->_state);
+			this->_reset();
+			return result;
+		}
+	};
+
+	template<>
+	class future<void>:
+		public detail::basic_future<void>
+	{
+		typedef detail::basic_future<void> _base;
+
+	public:
+		future() NOEXCEPT_FUNCTION
+		{}
+
+		explicit future(detail::future_state<void> *state) NOEXCEPT_FUNCTION:
+			_base(state)
+		{}
+
+		//! Wait for the operation to finish.
+		//! @throws the same as future<T>::get()
+		void get()
+		{
+			this->_check_state();
+
+			detail::future_state<void> *state = this->_state;
+			state->add_ref();
+			this->_reset();
+
+			try
+			{
+				state->get();
+				state->release();
+			}
+			catch (...)
+			{
+				state->release();
+				throw;
+			}
+		}
+
+		inline shared_future<void> share();
+	};
+
+	//! Shared future class.
+	//! Like future, but @c get() may be called any number of times and from any
+	//! number of copies.
+	template<class _Tp>
+	class shared_future:
+		public detail::basic_future<_Tp>
+	{
+		typedef detail::basic_future<_Tp> _base;
+
+	public:
+		shared_future() NOEXCEPT_FUNCTION
+		{}
+
+		explicit shared_future(detail::future_state<_Tp> *state) NOEXCEPT_FUNCTION:
+			_base(state)
+		{}
+
+		shared_future(const future<_Tp> &other) NOEXCEPT_FUNCTION:
+			_base(other)
+		{}
+
+		//! Wait for the result and return a reference to it.
+		//! @throws the same as future<T>::get()
+		const _Tp& get() const
+		{
+			this->_check_state();
+			return this->_state->get();
+		}
+	};
+
+	template<>
+	class shared_future<void>:
+		public detail::basic_future<void>
+	{
+		typedef detail::basic_future<void> _base;
+
+	public:
+		shared_future() NOEXCEPT_FUNCTION
+		{}
+
+		explicit shared_future(detail::future_state<void> *state) NOEXCEPT_FUNCTION:
+			_base(state)
+		{}
+
+		shared_future(const future<void> &other) NOEXCEPT_FUNCTION:
+			_base(other)
+		{}
+
+		//! Wait for the operation to finish.
+		//! @throws the same as future<T>::get()
+		void get() const
+		{
+			this->_check_state();
+			this->_state->get();
+		}
+	};
+
+	inline shared_future<void> future<void>::share()
+	{
+		shared_future<void> result(this->_state);
+		this->_reset();
+		return result;
+	}
+
+	namespace detail
+	{
+		// Common part of promise: owns the provider side of the state.
+		template<class _Tp>
+		class basic_promise
+		{
+		public:
+			//! Return the future associated with the promise (only once).
+			//! @throws future_error
+			future<_Tp> get_future()
+			{
+				_state->retrieve();
+				return future<_Tp>(_state);
+			}
+
+			//! Store an exception in the shared state. The future rethrows a
+			//! future_error or system_error as such, with its code, and any
+			//! other exception as @c std::runtime_error with the same message.
+			//! @throws future_error if the state already has a result.
+			void set_exception(const std::exception &e)
+			{
+				_state->set_exception(e);
+			}
+
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+			//! Store an exception in the shared state. The future rethrows it
+			//! as is.
+			//! @throws future_error if the state already has a result.
+			void set_exception(std::exception_ptr p)
+			{
+				_state->set_exception(p);
+			}
+#endif
+
+		protected:
+			future_state<_Tp> *_state;
+
+			basic_promise():
+				_state(new future_state<_Tp>())
+			{}
+
+			~basic_promise()
+			{
+				_state->abandon();
+				_state->release();
+			}
+
+		private:
+			basic_promise(const basic_promise&) DELETED_FUNCTION;
+			basic_promise& operator=(const basic_promise&) DELETED_FUNCTION;
+		};
+	}
+
+	//! Promise class.
+	//! Stores a value (or an exception) to be retrieved through the associated
+	//! future, possibly by another thread. A promise destroyed without storing
+	//! a result makes the future throw future_error(broken_promise).
+	template<class _Tp>
+	class promise:
+		public detail::basic_promise<_Tp>
+	{
+	public:
+		promise()
+		{}
+
+		//! Store the value and make the future ready.
+		//! @throws future_error if the state already has a result.
+		void set_value(const _Tp &value)
+		{
+			this->_state->set_value(value);
+		}
+	};
+
+	template<>
+	class promise<void>:
+		public detail::basic_promise<void>
+	{
+	public:
+		promise()
+		{}
+
+		//! Make the future ready.
+		//! @throws future_error if the state already has a result.
+		void set_value()
+		{
+			this->_state->set_value();
+		}
+	};
+
+	template<class _Signature>
+	class packaged_task;
+
+	//! Packaged task class.
+	//! Wraps a function or a function object returning @c _Res so that the
+	//! result of invoking it (or the exception it throws) becomes available
+	//! through a future. Example usage:
+	//! @code
+	//! packaged_task<int()> task(&compute);
+	//! future<int> result = task.get_future();
+	//!
+	//! thread t(&run_task, &task); // calls task()
+	//! int value = result.get();
+	//! @endcode
+	template<class _Res>
+	class packaged_task<_Res()>
+	{
+	public:
+		packaged_task() NOEXCEPT_FUNCTION:
+			_state(0)
+		{}
+
+		template<class _Fn>
+		explicit packaged_task(_Fn f):
+			_state(new detail::task_state<_Res, _Fn>(f))
+		{}
+
+		~packaged_task()
+		{
+			if (_state)
+			{
+				_state->abandon();
+				_state->release();
+			}
+		}
+
+		bool valid() const NOEXCEPT_FUNCTION
+		{
+			return _state != 0;
+		}
+
+		//! Return the future associated with the task (only once).
+		//! @throws future_error
+		future<_Res> get_future()
+		{
+			_check_state();
+			_state->retrieve();
+			return future<_Res>(_state);
+		}
+
+		//! Invoke the function and store the result (only once).
+		//! @throws future_error
+		void operator()()
+		{
+			_check_state();
+			_state->run();
+		}
+
+	private:
+		detail::future_state<_Res> *_state;
+
+		void _check_state() const
+		{
+			if (!_state)
+				throw future_error(future_errc::no_state);
+		}
+
+		packaged_task(const packaged_task&) DELETED_FUNCTION;
+		packaged_task& operator=(const packaged_task&) DELETED_FUNCTION;
+	};
+
+	//! Packaged task taking one argument.
+	//! @see packaged_task<_Res()>
+	template<class _Res, class _Arg>
+	class packaged_task<_Res(_Arg)>
+	{
+		struct state_base:
+			public detail::future_state<_Res>
+		{
+			virtual void run(_Arg arg) = 0;
+		};
+
+		template<class _Fn>
+		struct state:
+			public state_base
+		{
+			explicit state(const _Fn &f):
+				_f(f)
+			{}
+
+			virtual void run(_Arg arg)
+			{
+				this->_start_invocation();
+
+				try
+				{
+					detail::_invoke_and_set<_Res>::call(*this, _f, arg);
+				}
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+				catch (...)
+				{
+					this->set_exception(std::current_exception());
+				}
+#else
+				catch (const std::exception &e)
+				{
+					this->set_exception(e);
+				}
+				catch (...)
+				{
+					this->set_exception("unknown exception");
+				}
+#endif
+			}
+
+			_Fn _f;
+		};
+
+	public:
+		packaged_task() NOEXCEPT_FUNCTION:
+			_state(0)
+		{}
+
+		template<class _Fn>
+		explicit packaged_task(_Fn f):
+			_state(new state<_Fn>(f))
+		{}
+
+		~packaged_task()
+		{
+			if (_state)
+			{
+				_state->abandon();
+				_state->release();
+			}
+		}
+
+		bool valid() const NOEXCEPT_FUNCTION
+		{
+			return _state != 0;
+		}
+
+		//! Return the future associated with the task (only once).
+		//! @throws future_error
+		future<_Res> get_future()
+		{
+			_check_state();
+			_state->retrieve();
+			return future<_Res>(_state);
+		}
+
+		//! Invoke the function with @a arg and store the result (only once).
+		//! @throws future_error
+		void operator()(_Arg arg)
+		{
+			_check_state();
+			_state->run(arg);
+		}
+
+	private:
+		state_base *_state;
+
+		void _check_state() const
+		{
+			if (!_state)
+				throw future_error(future_errc::no_state);
+		}
+
+		packaged_task(const packaged_task&) DELETED_FUNCTION;
+		packaged_task& operator=(const packaged_task&) DELETED_FUNCTION;
+	};
+
+	namespace detail
+	{
+		// Function objects binding the arguments given to async.
+		template<class _Res>
+		struct _bound_function
+		{
+			typedef _Res(*function_type)();
+
+			explicit _bound_function(function_type func_) :func(func_) {}
+
+			function_type func;
+
+			_Res operator()() { return (*func)(); }
+		};
+
+		template<class _Res, class _Arg, class _Value>
+		struct _bound_function1
+		{
+			typedef _Res(*function_type)(_Arg);
+
+			_bound_function1(function_type func_, const _Value &arg_) :func(func_), arg(arg_) {}
+
+			function_type func;
+			_Value arg;
+
+			_Res operator()() { return (*func)(arg); }
+		};
+
+		template<class _Res, class _Class>
+		struct _bound_member
+		{
+			typedef _Res(_Class::*function_type)();
+
+			_bound_member(function_type func_, _Class *obj_) :func(func_), obj(obj_) {}
+
+			function_type func;
+			_Class *obj;
+
+			_Res operator()() { return (obj->*func)(); }
+		};
+
+		template<class _Res, class _Class, class _Arg, class _Value>
+		struct _bound_member1
+		{
+			typedef _Res(_Class::*function_type)(_Arg);
+
+			_bound_member1(function_type func_, _Class *obj_, const _Value &arg_) :func(func_), obj(obj_), arg(arg_) {}
+
+			function_type func;
+			_Class *obj;
+			_Value arg;
+
+			_Res operator()() { return (obj->*func)(arg); }
+		};
+
+		extern "C" inline void* _async_thread_function(void *aArg)
+		{
+			future_state_base *state = static_cast<future_state_base*>(aArg);
+
+			state->run();
+			state->release();
+
+			return 0;
+		}
+
+		template<class _Res, class _Fn>
+		future<_Res> _async(launch::type policy, const _Fn &f)
+		{
+			task_state<_Res, _Fn> *state = new task_state<_Res, _Fn>(f);
+			future<_Res> result(state);
+
+			state->release(); // future holds the reference now
+
+			if (policy & launch::async)
+			{
+				pthread_attr_t attr;
+				pthread_t handle;
+
+				pthread_attr_init(&attr);
+				pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+				state->add_ref(); // for the thread
+				int e = pthread_create(&handle, &attr, &_async_thread_function, static_cast<future_state_base*>(state));
+				pthread_attr_destroy(&attr);
+
+				if (e == 0)
+					return result;
+
+				state->release();
+
+				if (!(policy & launch::deferred))
+					throw system_error(errc(e));
+			}
+
+			state->set_deferred();
+
+			return result;
+		}
+	}
+
+	//! Run a function asynchronously and return a future for its result.
+	//! With @c launch::async the function runs on a new thread, with
+	//! @c launch::deferred it runs in the first thread waiting for the result.
+	//! When both are given (the default) a new thread is used unless one can't
+	//! be created. Exceptions thrown by the function are stored in the future.
+	//! Example usage:
+	//! @code
+	//! future<int> a = async(&load_part, 1);
+	//! future<int> b = async(&load_part, 2);
+	//! int total = a.get() + b.get();
+	//! @endcode
+	template<class _Res>
+	future<_Res> async(launch::type policy, _Res(*aFunction)())
+	{
+		return detail::_async<_Res>(policy, detail::_bound_function<_Res>(aFunction));
+	}
+
+	template<class _Res, class _Arg, class _Value>
+	future<_Res> async(launch::type policy, _Res(*aFunction)(_Arg), const _Value &aArg)
+	{
+		return detail::_async<_Res>(policy, detail::_bound_function1<_Res, _Arg, _Value>(aFunction, aArg));
+	}
+
+	template<class _Res, class _Class>
+	future<_Res> async(launch::type policy, _Res(_Class::*aFunction)(), _Class *obj)
+	{
+		return detail::_async<_Res>(policy, detail::_bound_member<_Res, _Class>(aFunction, obj));
+	}
+
+	template<class _Res, class _Class, class _Arg, class _Value>
+	future<_Res> async(launch::type policy, _Res(_Class::*aFunction)(_Arg), _Class *obj, const _Value &aArg)
+	{
+		return detail::_async<_Res>(policy, detail::_bound_member1<_Res, _Class, _Arg, _Value>(aFunction, obj, aArg));
+	}
+
+	template<class _Res>
+	future<_Res> async(_Res(*aFunction)())
+	{
+		return async(launch::type(launch::async | launch::deferred), aFunction);
+	}
+
+	template<class _Res, class _Arg, class _Value>
+	future<_Res> async(_Res(*aFunction)(_Arg), const _Value &aArg)
+	{
+		return async(launch::type(launch::async | launch::deferred), aFunction, aArg);
+	}
+
+	template<class _Res, class _Class>
+	future<_Res> async(_Res(_Class::*aFunction)(), _Class *obj)
+	{
+		return async(launch::type(launch::async | launch::deferred), aFunction, obj);
+	}
+
+	template<class _Res, class _Class, class _Arg, class _Value>
+	future<_Res> async(_Res(_Class::*aFunction)(_Arg), _Class *obj, const _Value &aArg)
+	{
+		return async(launch::type(launch::async | launch::deferred), aFunction, obj, aArg);
+	}
+
+} // namespace stdex
+
+#endif // _STDEX_FUTURE_H
@@ -0,0 +1,120 @@
+#ifndef _STDEX_LATCH_H
+#define _STDEX_LATCH_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+#include <climits>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Latch class.
+	//! Single-use countdown: threads block in @c wait() until the counter
+	//! reaches zero. The counter is a futex word, so counting down makes a
+	//! system call only when the counter reaches zero while threads sleep.
+	//! Example usage:
+	//! @code
+	//! latch done(workers);
+	//!
+	//! // every worker
+	//! ...
+	//! done.count_down();
+	//!
+	//! // coordinator
+	//! done.wait();
+	//! @endcode
+	class latch
+	{
+	public:
+		//! Maximal counter value supported.
+		static std::ptrdiff_t (max)() NOEXCEPT_FUNCTION
+		{
+			return INT_MAX;
+		}
+
+		//! Constructor.
+		//! @param[in] expected Initial counter value.
+		explicit latch(std::ptrdiff_t expected) NOEXCEPT_FUNCTION:
+			_count(static_cast<int>(expected)),
+			_waiters(0)
+		{}
+
+		//! Destructor.
+		~latch() NOEXCEPT_FUNCTION
+		{}
+
+		//! Decrement the counter by @a update, releasing the waiting threads
+		//! when it reaches zero.
+		void count_down(std::ptrdiff_t update = 1) NOEXCEPT_FUNCTION
+		{
+			if (_count.fetch_sub(static_cast<int>(update), memory_order_release) != update)
+				return;
+
+			// pairs with the fence in wait()
+			atomic_thread_fence(memory_order_seq_cst);
+
+			if (_waiters.load(memory_order_relaxed) != 0)
+				detail::futex_wake(_count, INT_MAX);
+		}
+
+		//! Check without blocking whether the counter reached zero.
+		bool try_wait() const NOEXCEPT_FUNCTION
+		{
+			return _count.load(memory_order_acquire) == 0;
+		}
+
+		//! Block until the counter reaches zero.
+		void wait() NOEXCEPT_FUNCTION
+		{
+			int count;
+
+			while ((count = _count.load(memory_order_acquire)) != 0)
+			{
+				_waiters.fetch_add(1, memory_order_relaxed);
+				atomic_thread_fence(memory_order_seq_cst);
+
+				detail::futex_wait(_count, count);
+
+				_waiters.fetch_sub(1, memory_order_relaxed);
+			}
+		}
+
+		//! Decrement the counter by @a update and wait for it to reach zero.
+		void arrive_and_wait(std::ptrdiff_t update = 1) NOEXCEPT_FUNCTION
+		{
+			count_down(update);
+			wait();
+		}
+
+	private:
+		atomic<int> _count;   //!< Futex word.
+		atomic<int> _waiters; //!< Threads sleeping or about to sleep on _count.
+
+		latch(const latch&) DELETED_FUNCTION;
+		latch& operator=(const latch&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_LATCH_H
@@ -0,0 +1,277 @@
+#ifndef _STDEX_MPMC_QUEUE_H
+#define _STDEX_MPMC_QUEUE_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./condition_variable"
+#include "./atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Bounded multi-producer/multi-consumer queue.
+	//! A lock-free ring buffer (D. Vyukov's algorithm): every cell carries a
+	//! sequence number telling producers and consumers whose turn it is, so
+	//! both sides claim a cell with a single compare-and-swap and never wait
+	//! for each other unless the queue is full or empty. The blocking
+	//! @c push() and @c pop() spin briefly and only then sleep on a
+	//! condition_variable. Example usage:
+	//! @code
+	//! mpmc_queue<job*> jobs(1024);
+	//!
+	//! // producers
+	//! jobs.push(new job(...));
+	//!
+	//! // consumers
+	//! job *j;
+	//! jobs.pop(j);
+	//! @endcode
+	//! @note @c _Tp has to be default constructible and assignable; the
+	//! buffer is allocated once with all the cells.
+	template<class _Tp>
+	class mpmc_queue
+	{
+	public:
+		typedef _Tp value_type;
+
+		//! Constructor.
+		//! @param[in] capacity Maximal number of elements, rounded up to a
+		//! power of 2 (at least 2).
+		//! @param[in] spin_count Number of retries of the blocking functions
+		//! before they go to sleep.
+		explicit mpmc_queue(std::size_t capacity, unsigned spin_count = 100):
+			_buffer(0),
+			_mask(0),
+			_spin_count(spin_count),
+			_enqueue_pos(0),
+			_dequeue_pos(0),
+			_push_waiters(0),
+			_pop_waiters(0)
+		{
+			std::size_t size = 2;
+
+			while (size < capacity)
+				size <<= 1;
+
+			_buffer = new cell[size];
+			_mask = size - 1;
+
+			for (std::size_t i = 0; i < size; ++i)
+				_buffer[i].sequence.store(i, memory_order_relaxed);
+		}
+
+		//! Destructor.
+		//! @note Must not be called while other threads use the queue.
+		~mpmc_queue()
+		{
+			delete [] _buffer;
+		}
+
+		//! Append @a value unless the queue is full.
+		//! @return @c false if the queue is full.
+		bool try_push(const _Tp &value)
+		{
+			if (!_try_push(value))
+				return false;
+
+			_notify(_pop_waiters, _not_empty);
+			return true;
+		}
+
+		//! Remove the first element and store it in @a value unless the queue
+		//! is empty.
+		//! @return @c false if the queue is empty.
+		bool try_pop(_Tp &value)
+		{
+			if (!_try_pop(value))
+				return false;
+
+			_notify(_push_waiters, _not_full);
+			return true;
+		}
+
+		//! Append @a value, blocking while the queue is full.
+		void push(const _Tp &value)
+		{
+			for (unsigned i = 0; i < _spin_count; ++i)
+			{
+				if (try_push(value))
+					return;
+				detail::cpu_relax();
+			}
+
+			unique_lock<mutex> lock(_lock);
+
+			_push_waiters.fetch_add(1, memory_order_relaxed);
+
+			// pairs with the fence in _notify(): either we see the free cell
+			// or the consumer sees us waiting
+			atomic_thread_fence(memory_order_seq_cst);
+
+			while (!_try_push(value))
+				_not_full.wait(lock);
+
+			_push_waiters.fetch_sub(1, memory_order_relaxed);
+
+			lock.unlock();
+
+			_notify(_pop_waiters, _not_empty);
+		}
+
+		//! Remove the first element and store it in @a value, blocking while
+		//! the queue is empty.
+		void pop(_Tp &value)
+		{
+			for (unsigned i = 0; i < _spin_count; ++i)
+			{
+				if (try_pop(value))
+					return;
+				detail::cpu_relax();
+			}
+
+			unique_lock<mutex> lock(_lock);
+
+			_pop_waiters.fetch_add(1, memory_order_relaxed);
+
+			// pairs with the fence in _notify()
+			atomic_thread_fence(memory_order_seq_cst);
+
+			while (!_try_pop(value))
+				_not_empty.wait(lock);
+
+			_pop_waiters.fetch_sub(1, memory_order_relaxed);
+
+			lock.unlock();
+
+			_notify(_push_waiters, _not_full);
+		}
+
+		//! Maximal number of elements.
+		std::size_t capacity() const NOEXCEPT_FUNCTION
+		{
+			return _mask + 1;
+		}
+
+	private:
+		struct cell
+		{
+			atomic<std::size_t> sequence;
+			_Tp data;
+		};
+
+		// Producers and consumers work on different cache lines.
+		char _pad0[_STDEX_CACHE_LINE_SIZE];
+		cell *_buffer;
+		std::size_t _mask;
+		unsigned _spin_count;
+		char _pad1[_STDEX_CACHE_LINE_SIZE];
+		atomic<std::size_t> _enqueue_pos;
+		char _pad2[_STDEX_CACHE_LINE_SIZE - sizeof(atomic<std::size_t>)];
+		atomic<std::size_t> _dequeue_pos;
+		char _pad3[_STDEX_CACHE_LINE_SIZE - sizeof(atomic<std::size_t>)];
+
+		// Slow path of the blocking functions only.
+		mutex _lock;
+		condition_variable _not_empty;
+		condition_variable _not_full;
+		atomic<long> _push_waiters;
+		atomic<long> _pop_waiters;
+
+		bool _try_push(const _Tp &value)
+		{
+			std::size_t pos = _enqueue_pos.load(memory_order_relaxed);
+			cell *c;
+
+			for (;;)
+			{
+				c = &_buffer[pos & _mask];
+
+				std::size_t seq = c->sequence.load(memory_order_acquire);
+				std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - pos);
+
+				if (dif == 0)
+				{// the cell is free, claim it
+					if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+						break;
+				}
+				else if (dif < 0) // the cell still holds the element of the previous lap
+					return false;
+				else // another producer was faster
+					pos = _enqueue_pos.load(memory_order_relaxed);
+			}
+
+			c->data = value;
+			c->sequence.store(pos + 1, memory_order_release);
+
+			return true;
+		}
+
+		bool _try_pop(_Tp &value)
+		{
+			std::size_t pos = _dequeue_pos.load(memory_order_relaxed);
+			cell *c;
+
+			for (;;)
+			{
+				c = &_buffer[pos & _mask];
+
+				std::size_t seq = c->sequence.load(memory_order_acquire);
+				std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+
+				if (dif == 0)
+				{// the cell is filled, claim it
+					if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+						break;
+				}
+				else if (dif < 0) // nothing pushed to the cell yet
+					return false;
+				else // another consumer was faster
+					pos = _dequeue_pos.load(memory_order_relaxed);
+			}
+
+			value = c->data;
+			c->sequence.store(pos + _mask + 1, memory_order_release);
+
+			return true;
+		}
+
+		// Wakes a thread sleeping in push() or pop() after the opposite
+		// operation succeeded; costs a fence when nobody sleeps.
+		void _notify(atomic<long> &waiters, condition_variable &cond)
+		{
+			atomic_thread_fence(memory_order_seq_cst);
+
+			if (waiters.load(memory_order_relaxed) == 0)
+				return;
+
+			lock_guard<mutex> guard(_lock);
+			cond.notify_one();
+		}
+
+		mpmc_queue(const mpmc_queue&) DELETED_FUNCTION;
+		mpmc_queue& operator=(const mpmc_queue&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_MPMC_QUEUE_H
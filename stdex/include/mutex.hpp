@@ -8,12 +8,23 @@
 // stdex includes
 #include "./system_error"
 #include "./chrono"
+#include "./atomic"
 
 // POSIX includes
 #include <pthread>
 
 // std includes
 #include <algorithm>
+#include <ctime> // for timespec
+
+#ifdef _MSC_VER
+#include <intrin.h> // for _mm_pause
+#endif
+
+// pthread_*_clocklock family to wait for deadlines on CLOCK_MONOTONIC
+#if defined(__GLIBC__) && defined(__USE_GNU) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+	#define _STDEX_HAS_PTHREAD_CLOCKLOCK
+#endif
 
 #ifdef _STDEX_HAS_CPP11_SUPPORT
 
@@ -204,6 +215,364 @@ namespace stdex
 		recursive_mutex& operator=(const recursive_mutex&) DELETED_FUNCTION;
 	};
 
+	namespace detail
+	{
+		// Hints the processor that the calling thread is spinning on a lock.
+		inline void cpu_relax() NOEXCEPT_FUNCTION
+		{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+			__asm__ __volatile__("pause" ::: "memory");
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+			_mm_pause();
+#endif
+		}
+
+		// Blocks the calling thread as long as word == expected. May return
+		// spuriously, so callers have to re-check their condition. Linux futex
+		// where available, emulated with hashed condition variables elsewhere.
+		void futex_wait(atomic<int> &word, int expected) NOEXCEPT_FUNCTION;
+
+		// Wakes at most count threads blocked in futex_wait on word.
+		void futex_wake(atomic<int> &word, int count) NOEXCEPT_FUNCTION;
+
+		// futex_wait with a deadline; returns false if the deadline passed.
+		bool futex_wait_until(atomic<int> &word, int expected, const chrono::steady_clock::time_point &deadline) NOEXCEPT_FUNCTION;
+
+		// Converts an absolute time point to the timespec POSIX timed functions expect.
+		template<class _Clock, class _Duration>
+		inline timespec _to_timespec(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			chrono::time_point<_Clock, chrono::seconds> s = chrono::time_point_cast<chrono::seconds>(atime);
+			chrono::nanoseconds ns = chrono::duration_cast<chrono::nanoseconds>(atime - s);
+
+			timespec ts;
+			ts.tv_sec = static_cast<stdex::time_t>(s.time_since_epoch().count());
+			ts.tv_nsec = static_cast<long>(ns.count());
+
+			return ts;
+		}
+	}
+
+	//! Timed acquisition shared by timed_mutex and recursive_timed_mutex.
+	//! Deadlines on the steady clock are waited for with
+	//! pthread_mutex_clocklock(CLOCK_MONOTONIC) where available, deadlines on
+	//! the system clock with pthread_mutex_timedlock. Deadlines on any other
+	//! clock are converted to the steady clock.
+	template<class _MutexBase>
+	class timed_mutex_base:
+		protected _MutexBase
+	{
+	protected:
+		timed_mutex_base()
+		{}
+
+		~timed_mutex_base()
+		{}
+
+		template<class _Rep, class _Period>
+		bool _try_lock_for(const chrono::duration<_Rep, _Period> &rtime)
+		{
+			return _try_lock_until(chrono::steady_clock::now() + rtime);
+		}
+
+		template<class _Duration>
+		bool _try_lock_until(const chrono::time_point<chrono::steady_clock, _Duration> &atime)
+		{
+#ifdef _STDEX_HAS_PTHREAD_CLOCKLOCK
+			timespec ts = detail::_to_timespec(atime);
+
+			return _timedlock_result(pthread_mutex_clocklock(&this->_mutex_handle, CLOCK_MONOTONIC, &ts));
+#else
+			// no clock selection for mutexes: wait on the system clock and
+			// re-check so that a clock step can only cause a spurious retry
+			chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+			while (now < atime)
+			{
+				if (_try_lock_until(chrono::system_clock::now() + (atime - now)))
+					return true;
+				now = chrono::steady_clock::now();
+			}
+
+			return (pthread_mutex_trylock(&this->_mutex_handle) == 0);
+#endif
+		}
+
+		template<class _Duration>
+		bool _try_lock_until(const chrono::time_point<chrono::system_clock, _Duration> &atime)
+		{
+			timespec ts = detail::_to_timespec(atime);
+
+			return _timedlock_result(pthread_mutex_timedlock(&this->_mutex_handle, &ts));
+		}
+
+		template<class _Clock, class _Duration>
+		bool _try_lock_until(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			// DR 887 - Sync unknown clock to known clock. _Clock may run at
+			// another rate so check it again after every timeout.
+			typename _Clock::time_point now = _Clock::now();
+
+			do
+			{
+				if (_try_lock_until(chrono::steady_clock::now() + (atime - now)))
+					return true;
+				now = _Clock::now();
+			} while (now < atime);
+
+			return false;
+		}
+
+	private:
+		static bool _timedlock_result(int e)
+		{
+			if (e == 0)
+				return true;
+
+			// EINVAL, EAGAIN, EDEADLK(may)
+			if (e != ETIMEDOUT)
+				throw system_error(errc(e));
+
+			return false;
+		}
+	};
+
+	//! Timed mutex class.
+	//! Non-recursive mutex that additionally lets the calling thread give up
+	//! waiting for the lock after a timeout or at a deadline.
+	//! @see mutex
+	//! @see recursive_timed_mutex
+	class timed_mutex:
+		private timed_mutex_base<mutex_base>
+	{
+	public:
+		typedef pthread_mutex_t* native_handle_type;
+
+		//! Constructor.
+		timed_mutex()
+		{}
+
+		//! Destructor.
+		~timed_mutex()
+		{}
+
+		//! Lock the mutex.
+		//! The method will block the calling thread until a lock on the mutex can
+		//! be obtained. The mutex remains locked until @c unlock() is called.
+		//! @see lock_guard
+		//! @throws system_error
+		inline void lock()
+		{
+			int e = pthread_mutex_lock(&_mutex_handle);
+
+			// EINVAL, EAGAIN, EBUSY, EINVAL, EDEADLK(may)
+			if (e)
+				throw system_error(errc(e));
+		}
+
+		//! Try to lock the mutex.
+		//! The method will try to lock the mutex. If it fails, the function will
+		//! return immediately (non-blocking).
+		//! @return @c true if the lock was acquired, or @c false if the lock could
+		//! not be acquired.
+		inline bool try_lock() NOEXCEPT_FUNCTION
+		{
+			// XXX EINVAL, EAGAIN, EBUSY
+			return (pthread_mutex_trylock(&_mutex_handle) == 0) ? true : false;
+		}
+
+		//! Try to lock the mutex, blocking for at most @a rtime.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		//! @throws system_error
+		template<class _Rep, class _Period>
+		inline bool try_lock_for(const chrono::duration<_Rep, _Period> &rtime)
+		{
+			return _try_lock_for(rtime);
+		}
+
+		//! Try to lock the mutex, blocking until @a atime at the latest.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		//! @throws system_error
+		template<class _Clock, class _Duration>
+		inline bool try_lock_until(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			return _try_lock_until(atime);
+		}
+
+		//! Unlock the mutex.
+		//! If any threads are waiting for the lock on this mutex, one of them will
+		//! be unblocked.
+		inline void unlock()
+		{
+			pthread_mutex_unlock(&_mutex_handle);
+		}
+
+		native_handle_type native_handle() NOEXCEPT_FUNCTION
+		{
+			return &_mutex_handle;
+		}
+
+	private:
+		timed_mutex(const timed_mutex&) DELETED_FUNCTION;
+		timed_mutex& operator=(const timed_mutex&) DELETED_FUNCTION;
+	};
+
+	//! Recursive timed mutex class.
+	//! Recursive mutex that additionally lets the calling thread give up
+	//! waiting for the lock after a timeout or at a deadline.
+	//! @see recursive_mutex
+	//! @see timed_mutex
+	class recursive_timed_mutex:
+		private timed_mutex_base<recursive_mutex_base>
+	{
+	public:
+		typedef pthread_mutex_t* native_handle_type;
+
+		//! Constructor.
+		recursive_timed_mutex()
+		{}
+
+		//! Destructor.
+		~recursive_timed_mutex()
+		{}
+
+		//! Lock the mutex.
+		//! The method will block the calling thread until a lock on the mutex can
+		//! be obtained. The mutex remains locked until @c unlock() is called.
+		//! @see lock_guard
+		//! @throws system_error
+		inline void lock()
+		{
+			int e = pthread_mutex_lock(&_mutex_handle);
+
+			// EINVAL, EAGAIN, EBUSY, EINVAL, EDEADLK(may)
+			if (e)
+				throw system_error(errc(e));
+		}
+
+		//! Try to lock the mutex.
+		//! The method will try to lock the mutex. If it fails, the function will
+		//! return immediately (non-blocking).
+		//! @return @c true if the lock was acquired, or @c false if the lock could
+		//! not be acquired.
+		inline bool try_lock()
+		{
+			// XXX EINVAL, EAGAIN, EBUSY
+			return (pthread_mutex_trylock(&_mutex_handle) == 0) ? true : false;
+		}
+
+		//! Try to lock the mutex, blocking for at most @a rtime.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		//! @throws system_error
+		template<class _Rep, class _Period>
+		inline bool try_lock_for(const chrono::duration<_Rep, _Period> &rtime)
+		{
+			return _try_lock_for(rtime);
+		}
+
+		//! Try to lock the mutex, blocking until @a atime at the latest.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		//! @throws system_error
+		template<class _Clock, class _Duration>
+		inline bool try_lock_until(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			return _try_lock_until(atime);
+		}
+
+		//! Unlock the mutex.
+		//! If any threads are waiting for the lock on this mutex, one of them will
+		//! be unblocked.
+		inline void unlock()
+		{
+			// XXX EINVAL, EAGAIN, EBUSY
+			pthread_mutex_unlock(&_mutex_handle);
+		}
+
+		native_handle_type native_handle() NOEXCEPT_FUNCTION
+		{
+			return &_mutex_handle;
+		}
+
+	private:
+		recursive_timed_mutex(const recursive_timed_mutex&) DELETED_FUNCTION;
+		recursive_timed_mutex& operator=(const recursive_timed_mutex&) DELETED_FUNCTION;
+	};
+
+	//! Adaptive mutex class.
+	//! Non-recursive mutex for very short critical sections. On contention
+	//! the calling thread first spins with an exponential pause backoff for a
+	//! bounded number of iterations and only then parks in the kernel
+	//! (futex), so a lock released within a few hundred cycles is taken
+	//! without a context switch. Unlocking a mutex nobody waits for costs no
+	//! system call.
+	//! @note There is no pthread handle behind this mutex, so it can't be used
+	//! with condition_variable.
+	//! @see mutex
+	class adaptive_mutex
+	{
+	public:
+		//! Constructor.
+		//! @param[in] spin_count Number of spin iterations before the calling
+		//! thread is put to sleep.
+		explicit adaptive_mutex(unsigned spin_count = 100) NOEXCEPT_FUNCTION:
+			_state(_unlocked),
+			_spin_count(spin_count)
+		{}
+
+		//! Destructor.
+		~adaptive_mutex() NOEXCEPT_FUNCTION
+		{}
+
+		//! Lock the mutex.
+		//! The method will block the calling thread until a lock on the mutex can
+		//! be obtained. The mutex remains locked until @c unlock() is called.
+		//! @see lock_guard
+		inline void lock() NOEXCEPT_FUNCTION
+		{
+			int expected = _unlocked;
+
+			if (!_state.compare_exchange_strong(expected, _locked, memory_order_acquire))
+				_lock_contended();
+		}
+
+		//! Try to lock the mutex.
+		//! The method will try to lock the mutex. If it fails, the function will
+		//! return immediately (non-blocking).
+		//! @return @c true if the lock was acquired, or @c false if the lock could
+		//! not be acquired.
+		inline bool try_lock() NOEXCEPT_FUNCTION
+		{
+			int expected = _unlocked;
+
+			return _state.compare_exchange_strong(expected, _locked, memory_order_acquire);
+		}
+
+		//! Unlock the mutex.
+		//! If any threads are waiting for the lock on this mutex, one of them will
+		//! be unblocked.
+		inline void unlock() NOEXCEPT_FUNCTION
+		{
+			if (_state.exchange(_unlocked, memory_order_release) == _contended)
+				detail::futex_wake(_state, 1);
+		}
+
+	private:
+		enum
+		{
+			_unlocked = 0,
+			_locked = 1, // locked, nobody sleeps on the futex
+			_contended = 2 // locked, there may be sleepers
+		};
+
+		atomic<int> _state;
+		unsigned _spin_count;
+
+		void _lock_contended() NOEXCEPT_FUNCTION;
+
+		adaptive_mutex(const adaptive_mutex&) DELETED_FUNCTION;
+		adaptive_mutex& operator=(const adaptive_mutex&) DELETED_FUNCTION;
+	};
+
 	// LOCK PROPERTIES
 	struct adopt_lock_t
 	{};
@@ -459,6 +828,119 @@ namespace stdex
 		lhs.swap(rhs);
 	}
 
+	namespace detail
+	{
+		// States of the word behind once_flag. Zero is the initial state, so
+		// a zero-initialized atomic<int> with static storage duration can be
+		// used before any constructor ran.
+		enum
+		{
+			_once_not_called = 0,
+			_once_running = 1,
+			_once_running_waiters = 2, // somebody sleeps on the futex
+			_once_done = 3
+		};
+
+		// Slow path of call_once. Returns true if the caller has to call the
+		// function and report with _once_end(), false if another thread
+		// already did it.
+		bool _once_begin(atomic<int> &state) NOEXCEPT_FUNCTION;
+
+		// Marks the function called (or not, if it threw) and wakes the waiters.
+		void _once_end(atomic<int> &state, bool called) NOEXCEPT_FUNCTION;
+
+		template<class _Callable>
+		inline void _call_once(atomic<int> &state, _Callable func)
+		{
+			// the only cost once the function was called
+			if (state.load(memory_order_acquire) == _once_done)
+				return;
+
+			if (!_once_begin(state))
+				return;
+
+			try
+			{
+				func();
+			}
+			catch (...)
+			{
+				_once_end(state, false);
+				throw;
+			}
+
+			_once_end(state, true);
+		}
+
+		template<class _Callable, class _Arg>
+		struct _once_bound_call
+		{
+			_once_bound_call(_Callable func_, _Arg arg_) :func(func_), arg(arg_) {}
+
+			_Callable func;
+			_Arg arg;
+
+			void operator()() { func(arg); }
+		};
+	}
+
+	//! Once flag class.
+	//! Flag for call_once(). Example usage:
+	//! @code
+	//! once_flag table_initialized;
+	//!
+	//! const table& get_table()
+	//! {
+	//!   call_once(table_initialized, &init_table);
+	//!   return the_table;
+	//! }
+	//! @endcode
+	//! @note Without C++ 11 support the constructor is not constant, so a
+	//! once_flag with static storage duration must not be used by
+	//! constructors of static objects in other translation units.
+	class once_flag
+	{
+	public:
+#ifdef _STDEX_NATIVE_CPP11_SUPPORT
+		constexpr once_flag() noexcept:
+#else
+		once_flag() NOEXCEPT_FUNCTION:
+#endif
+			_state(detail::_once_not_called)
+		{}
+
+	private:
+		atomic<int> _state;
+
+		template<class _Callable>
+		friend void call_once(once_flag &flag, _Callable func);
+
+		template<class _Callable, class _Arg>
+		friend void call_once(once_flag &flag, _Callable func, _Arg arg);
+
+		once_flag(const once_flag&) DELETED_FUNCTION;
+		once_flag& operator=(const once_flag&) DELETED_FUNCTION;
+	};
+
+	//! Call @a func exactly once for @a flag.
+	//! Threads calling call_once() while another one calls @a func block
+	//! until it returns. If @a func throws, the exception is propagated and
+	//! the next caller calls its function instead. Once @a func returned,
+	//! call_once() costs a single acquire load.
+	template<class _Callable>
+	inline void call_once(once_flag &flag, _Callable func)
+	{
+		detail::_call_once(flag._state, func);
+	}
+
+	//! Call <tt>func(arg)</tt> exactly once for @a flag.
+	//! @see call_once(once_flag&, _Callable)
+	template<class _Callable, class _Arg>
+	inline void call_once(once_flag &flag, _Callable func, _Arg arg)
+	{
+		detail::_call_once(flag._state, detail::_once_bound_call<_Callable, _Arg>(func, arg));
+	}
+
 } // namespace stdex
 
 
@@ -0,0 +1,294 @@
+#ifndef _STDEX_PROFILED_MUTEX_H
+#define _STDEX_PROFILED_MUTEX_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./thread"
+#include "./thread_specific_ptr"
+#include "./chrono"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <vector>
+#include <ostream>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw()
+
+#else
+
+#define DELETED_FUNCTION
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Lock statistics of one thread (or of all threads) at one lock site.
+	struct mutex_stats
+	{
+		thread::id owner;                     //!< Thread that took the lock; thread::id() in a site total.
+		uintmax_t acquisitions;               //!< Times the lock was taken.
+		uintmax_t contended;                  //!< Of them, times the lock was held by another thread.
+		chrono::nanoseconds wait_time;        //!< Time spent blocked in lock().
+		chrono::nanoseconds max_wait_time;
+		chrono::nanoseconds hold_time;        //!< Time from taking the lock to unlock().
+		chrono::nanoseconds max_hold_time;
+
+		mutex_stats() :
+			acquisitions(0),
+			contended(0)
+		{}
+	};
+
+	//! Lock statistics of one lock site.
+	struct mutex_site_stats
+	{
+		const char *site;                     //!< Name given by the tag of the profiled_mutex.
+		mutex_stats total;                    //!< Sum (and maximum) over all threads.
+		std::vector<mutex_stats> threads;     //!< One entry per thread, most waiting first.
+	};
+
+	//! Statistics of all lock sites, most waited for first (by total wait time,
+	//! then by contended acquisitions).
+	//! @note Empty unless @c _STDEX_PROFILE_MUTEX is defined.
+	std::vector<mutex_site_stats> mutex_profile_snapshot();
+
+	//! Write the statistics of all lock sites as a table ranked like
+	//! mutex_profile_snapshot(), with a line per thread below each site.
+	void write_mutex_profile(std::ostream &out);
+
+	namespace detail
+	{
+		// Counters of one thread at one lock site. Written only by that
+		// thread, read by mutex_profile_snapshot(); never freed, so threads
+		// that have exited still show up in the report.
+		struct _mutex_profile_record
+		{
+			thread::id owner;
+			atomic<uintmax_t> acquisitions;
+			atomic<uintmax_t> contended;
+			atomic<intmax_t> wait_ns;
+			atomic<intmax_t> max_wait_ns;
+			atomic<intmax_t> hold_ns;
+			atomic<intmax_t> max_hold_ns;
+			_mutex_profile_record *next;
+		};
+
+		// One lock site; a zero-initialized static per tag.
+		struct _mutex_profile_site
+		{
+			const char *name;
+			atomic<_mutex_profile_record*> records;
+			_mutex_profile_site *next;
+		};
+
+		// Add site to the list walked by mutex_profile_snapshot().
+		void _mutex_profile_register(_mutex_profile_site &site, const char *name);
+
+		// Allocate the record of the calling thread and link it into site.
+		_mutex_profile_record* _mutex_profile_attach(_mutex_profile_site &site);
+
+		// CLOCK_MONOTONIC in nanoseconds.
+		intmax_t _mutex_profile_now() NOEXCEPT_FUNCTION;
+
+		// The lock site named by _Tag and the records of its threads.
+		template<class _Tag>
+		struct _mutex_profile_site_of
+		{
+			static _mutex_profile_site site;
+			static atomic<int> site_once;
+
+			struct record_tag;
+			typedef thread_local_pod<_mutex_profile_record*, record_tag> thread_record;
+
+			static void register_site()
+			{
+				_mutex_profile_register(site, _Tag::name());
+			}
+
+			// Record of the calling thread, created on first use.
+			static _mutex_profile_record& record()
+			{
+				_mutex_profile_record *r = thread_record::get();
+
+				if (!r)
+				{
+					_call_once(site_once, &register_site);
+					r = _mutex_profile_attach(site);
+					thread_record::set(r);
+				}
+
+				return *r;
+			}
+		};
+
+		template<class _Tag>
+		_mutex_profile_site _mutex_profile_site_of<_Tag>::site; // zero-initialized
+
+		template<class _Tag>
+		atomic<int> _mutex_profile_site_of<_Tag>::site_once; // zero-initialized, see _call_once
+	}
+
+	//! Mutex that records how it is used.
+	//! Wraps a lockable @a _Mutex (mutex by default, recursive_mutex works as
+	//! well) and counts, per thread, the acquisitions, the contended ones (the
+	//! lock was held by another thread), the time spent waiting for the lock
+	//! and the time it was held. All profiled_mutex objects with the same
+	//! @a _Tag form one lock site; the tag names it through a static
+	//! @c name() function. Example usage:
+	//! @code
+	//! struct cache_lock { static const char* name() { return "cache"; } };
+	//!
+	//! profiled_mutex<cache_lock> m;
+	//!
+	//! {
+	//!   lock_guard<profiled_mutex<cache_lock> > guard(m);
+	//!   ...
+	//! }
+	//!
+	//! write_mutex_profile(std::cerr);
+	//! @endcode
+	//! Recording is compiled in only when @c _STDEX_PROFILE_MUTEX is defined;
+	//! otherwise the members forward to @a _Mutex and nothing is counted.
+	//! Counters are per thread so recording takes no shared cache line
+	//! beyond the mutex itself, at the price of two clock reads per
+	//! acquisition (three when contended).
+	//! @note Use condition_variable_any to wait on a profiled_mutex.
+	//! @see mutex_profile_snapshot, write_mutex_profile
+	template<class _Tag, class _Mutex = mutex>
+	class profiled_mutex
+	{
+	public:
+		typedef typename _Mutex::native_handle_type native_handle_type;
+
+		//! Constructor.
+		profiled_mutex()
+#ifdef _STDEX_PROFILE_MUTEX
+			: _depth(0),
+			_acquired_ns(0)
+#endif
+		{}
+
+		//! Destructor.
+		~profiled_mutex()
+		{}
+
+		//! Lock the mutex.
+		//! @see _Mutex::lock
+		//! @throws system_error
+		inline void lock()
+		{
+#ifdef _STDEX_PROFILE_MUTEX
+			if (_mutex.try_lock())
+			{
+				_acquired(0, false);
+				return;
+			}
+
+			intmax_t start = detail::_mutex_profile_now();
+
+			_mutex.lock();
+
+			_acquired(start, true);
+#else
+			_mutex.lock();
+#endif
+		}
+
+		//! Try to lock the mutex.
+		//! A failed attempt is not counted.
+		//! @return @c true if the lock was acquired, or @c false if the lock could
+		//! not be acquired.
+		inline bool try_lock()
+		{
+			if (!_mutex.try_lock())
+				return false;
+
+#ifdef _STDEX_PROFILE_MUTEX
+			_acquired(0, false);
+#endif
+			return true;
+		}
+
+		//! Unlock the mutex.
+		inline void unlock()
+		{
+#ifdef _STDEX_PROFILE_MUTEX
+			if (--_depth == 0)
+			{
+				detail::_mutex_profile_record &r = _site::record();
+				intmax_t held = detail::_mutex_profile_now() - _acquired_ns;
+
+				_add(r.hold_ns, held);
+				_max(r.max_hold_ns, held);
+			}
+#endif
+			_mutex.unlock();
+		}
+
+		native_handle_type native_handle()
+		{
+			return _mutex.native_handle();
+		}
+
+	private:
+		_Mutex _mutex;
+
+#ifdef _STDEX_PROFILE_MUTEX
+		typedef detail::_mutex_profile_site_of<_Tag> _site;
+
+		// Both touched only by the owner, under _mutex.
+		unsigned _depth;
+		intmax_t _acquired_ns;
+
+		// Plain load and store: a record has a single writer.
+		template<class _Tp>
+		static void _add(atomic<_Tp> &counter, _Tp value)
+		{
+			counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+		}
+
+		static void _max(atomic<intmax_t> &counter, intmax_t value)
+		{
+			if (value > counter.load(memory_order_relaxed))
+				counter.store(value, memory_order_relaxed);
+		}
+
+		void _acquired(intmax_t wait_start, bool contended)
+		{
+			if (_depth++)
+				return;
+
+			_acquired_ns = detail::_mutex_profile_now();
+
+			detail::_mutex_profile_record &r = _site::record();
+
+			_add<uintmax_t>(r.acquisitions, 1);
+
+			if (contended)
+			{
+				intmax_t waited = _acquired_ns - wait_start;
+
+				_add<uintmax_t>(r.contended, 1);
+				_add(r.wait_ns, waited);
+				_max(r.max_wait_ns, waited);
+			}
+		}
+#endif
+
+		profiled_mutex(const profiled_mutex&) DELETED_FUNCTION;
+		profiled_mutex& operator=(const profiled_mutex&) DELETED_FUNCTION;
+	};
+
+} // namespace stdex
+
+#endif // _STDEX_PROFILED_MUTEX_H
@@ -71,56 +71,56 @@ namespace stdex
 		// since we have no static_assert in pre-C++11 we just compile-time assert this way:
 		struct ratio_asserts
 		{
-			template<bool> 
+			template<bool _Cond, class _Dummy = void>
 			struct overflow_in_multiplication_assert; // if you are there means overflow in safe template multiplication occured
 
-			template<> 
-			struct overflow_in_multiplication_assert<true> 
+			template<class _Dummy>
+			struct overflow_in_multiplication_assert<true, _Dummy>
 			{
 				typedef bool is_ok;
 			};
 
-			template<bool>
+			template<bool _Cond, class _Dummy = void>
 			struct internal_library_error_assert; // if you are there means internal library error occured
 
-			template<>
-			struct internal_library_error_assert<true>
+			template<class _Dummy>
+			struct internal_library_error_assert<true, _Dummy>
 			{
 				typedef bool is_ok;
 			};
 
-			template<bool>
+			template<bool _Cond, class _Dummy = void>
 			struct denominator_cant_be_zero_assert; // if you are there means you put the denominator to zero
 
-			template<>
-			struct denominator_cant_be_zero_assert<true>
+			template<class _Dummy>
+			struct denominator_cant_be_zero_assert<true, _Dummy>
 			{
 				typedef bool is_ok;
 			};
 
-			template<bool>
+			template<bool _Cond, class _Dummy = void>
 			struct out_of_range; // if you are there means that value is out of range
 
-			template<>
-			struct out_of_range<true>
+			template<class _Dummy>
+			struct out_of_range<true, _Dummy>
 			{
 				typedef bool is_ok;
 			};
 
-			template<bool>
+			template<bool _Cond, class _Dummy = void>
 			struct division_by_zero; // if you are there means that divider is zero
 
-			template<>
-			struct division_by_zero<true>
+			template<class _Dummy>
+			struct division_by_zero<true, _Dummy>
 			{
 				typedef bool is_ok;
 			};
 
-			template<bool>
+			template<bool _Cond, class _Dummy = void>
 			struct overflow_in_addition_assert; // if you are there means overflow in safe template addition occured
 
-			template<>
-			struct overflow_in_addition_assert<true>
+			template<class _Dummy>
+			struct overflow_in_addition_assert<true, _Dummy>
 			{
 				typedef bool is_ok;
 			};
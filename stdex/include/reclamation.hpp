@@ -0,0 +1,313 @@
+#ifndef _STDEX_RECLAMATION_H
+#define _STDEX_RECLAMATION_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./atomic"
+#include "./thread_specific_ptr"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+#include <vector>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw()
+
+#else
+
+#define DELETED_FUNCTION
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	namespace detail
+	{
+		// Object waiting to be reclaimed, with its deleter type-erased like
+		// the cleanup of a thread_specific_ptr.
+		struct _retired
+		{
+			void *ptr;
+			void(*deleter)();
+			void(*invoke)(void(*)(), void*);
+
+			void reclaim() const
+			{
+				invoke(deleter, ptr);
+			}
+		};
+
+		template<class T>
+		struct _retire_traits
+		{
+			typedef void(*deleter_type)(T*);
+
+			static void default_delete(T *p)
+			{
+				delete p;
+			}
+
+			static void invoke(void(*deleter)(), void *p)
+			{
+				reinterpret_cast<deleter_type>(deleter)(static_cast<T*>(p));
+			}
+
+			static _retired make(T *p, deleter_type deleter)
+			{
+				_retired r;
+
+				r.ptr = p;
+				r.deleter = reinterpret_cast<void(*)()>(deleter);
+				r.invoke = &invoke;
+
+				return r;
+			}
+		};
+	}
+
+	//! Epoch-based memory reclamation domain.
+	//! Lets the readers of a lock-free structure follow pointers without
+	//! locking while writers unlink and retire nodes: a retired object is
+	//! deleted once every thread that was reading when it was retired has
+	//! left its read-side section. Readers mark their sections with an
+	//! epoch_domain::guard, which costs a store and a fence; a global epoch
+	//! advances when all threads inside a guard have seen the current one,
+	//! and objects retired two epochs back are freed. Example usage:
+	//! @code
+	//! epoch_domain ebr;
+	//! atomic<config*> current;
+	//!
+	//! void read()
+	//! {
+	//!   epoch_domain::guard g(ebr);
+	//!   use(current.load(memory_order_acquire));
+	//! }
+	//!
+	//! void update(config *c)
+	//! {
+	//!   ebr.retire(current.exchange(c));
+	//! }
+	//! @endcode
+	//! Every thread gets a participation record on first use; it is given
+	//! back when the thread exits (from the exit path of stdex::thread, or
+	//! the key destructor of any other thread) and reused by later threads.
+	//! @note A thread stalled inside a guard stops all reclamation; use a
+	//! hazard_domain where unreclaimed memory must stay bounded.
+	//! @note The domain must outlive the threads using it.
+	class epoch_domain
+	{
+		struct record;
+
+	public:
+		//! Read-side section; may be nested.
+		class guard
+		{
+		public:
+			explicit guard(epoch_domain &domain) :
+				_record(domain._enter())
+			{}
+
+			~guard()
+			{
+				epoch_domain::_leave(*_record);
+			}
+
+		private:
+			record *_record;
+
+			guard(const guard&) DELETED_FUNCTION;
+			guard& operator=(const guard&) DELETED_FUNCTION;
+		};
+
+		friend class guard;
+
+		//! Constructor.
+		//! @param[in] threshold Number of objects a thread retires before it
+		//! tries to advance the epoch and reclaim.
+		explicit epoch_domain(std::size_t threshold = 64);
+
+		//! Destructor.
+		//! Deletes all retired objects; no thread may be inside a guard.
+		~epoch_domain();
+
+		//! Delete @a p with @c delete once no reader can hold it.
+		//! @a p must be unreachable for new readers already.
+		template<class T>
+		void retire(T *p)
+		{
+			retire(p, &detail::_retire_traits<T>::default_delete);
+		}
+
+		//! Call <tt>deleter(p)</tt> once no reader can hold @a p.
+		template<class T>
+		void retire(T *p, void(*deleter)(T*))
+		{
+			_retire(detail::_retire_traits<T>::make(p, deleter));
+		}
+
+		//! Try to advance the epoch and delete what the calling thread (or a
+		//! thread that has exited) has retired and is safe to delete by now.
+		void collect();
+
+	private:
+		atomic<unsigned long> _epoch;
+		atomic<record*> _records;         //!< All records, never removed before destruction.
+		std::size_t _threshold;
+		thread_specific_ptr<record> _local;
+
+		record* _enter();
+		static void _leave(record &r) NOEXCEPT_FUNCTION;
+
+		record& _acquire();
+		void _retire(const detail::_retired &r);
+		bool _try_advance(unsigned long epoch);
+		void _reclaim(record &r, unsigned long epoch);
+
+		static void _release(record *r);
+
+		epoch_domain(const epoch_domain&) DELETED_FUNCTION;
+		epoch_domain& operator=(const epoch_domain&) DELETED_FUNCTION;
+	};
+
+	//! Hazard pointer memory reclamation domain.
+	//! A reader publishes the pointer it is about to follow in a hazard
+	//! pointer; a retired object is deleted once no hazard pointer holds it.
+	//! Unlike epoch_domain a stalled reader only keeps the objects it
+	//! protects alive: a thread holds at most @c threshold retired objects
+	//! plus one per hazard pointer in use. The price is a full fence for
+	//! every pointer protected. Example usage:
+	//! @code
+	//! hazard_domain hp;
+	//! atomic<node*> head;
+	//!
+	//! bool front(int &value)
+	//! {
+	//!   hazard_domain::hazard_pointer h(hp);
+	//!   node *n = h.protect(head);
+	//!
+	//!   if (!n)
+	//!     return false;
+	//!   value = n->value;
+	//!   return true;
+	//! }
+	//! @endcode
+	//! Threads get their records like with epoch_domain.
+	//! @note The domain must outlive the threads using it.
+	class hazard_domain
+	{
+		struct record;
+
+	public:
+		enum { max_hazards = 8 }; //!< Hazard pointers a thread may hold at a time.
+
+		//! Hazard pointer of the calling thread.
+		class hazard_pointer
+		{
+		public:
+			//! Take a free hazard pointer of the calling thread.
+			//! @throws system_error if the thread holds @c max_hazards already.
+			explicit hazard_pointer(hazard_domain &domain);
+
+			//! Clear and give back the hazard pointer.
+			~hazard_pointer();
+
+			//! Load @a src and protect the loaded pointer: the object it
+			//! points to is not deleted until reset() or protect() is called
+			//! again.
+			template<class T>
+			T* protect(const atomic<T*> &src) NOEXCEPT_FUNCTION
+			{
+				T *p = src.load(memory_order_relaxed);
+
+				for (;;)
+				{
+					_slot->store(p, memory_order_relaxed);
+
+					// Orders the hazard before the reload, pairs with the
+					// fence of _scan()
+					atomic_thread_fence(memory_order_seq_cst);
+
+					T *current = src.load(memory_order_acquire);
+
+					if (current == p)
+						return p;
+
+					p = current;
+				}
+			}
+
+			//! Protect @a p, which the caller has validated to be reachable
+			//! after this call.
+			void reset(void *p = 0) NOEXCEPT_FUNCTION
+			{
+				_slot->store(p, memory_order_relaxed);
+
+				// Orders the hazard before the caller's validating load
+				if (p)
+					atomic_thread_fence(memory_order_seq_cst);
+			}
+
+		private:
+			record *_record;
+			atomic<void*> *_slot;
+
+			hazard_pointer(const hazard_pointer&) DELETED_FUNCTION;
+			hazard_pointer& operator=(const hazard_pointer&) DELETED_FUNCTION;
+		};
+
+		friend class hazard_pointer;
+
+		//! Constructor.
+		//! @param[in] threshold Number of objects a thread retires before it
+		//! scans the hazard pointers and deletes the unprotected ones.
+		explicit hazard_domain(std::size_t threshold = 64);
+
+		//! Destructor.
+		//! Deletes all retired objects; no hazard pointer may be in use.
+		~hazard_domain();
+
+		//! Delete @a p with @c delete once no hazard pointer holds it.
+		//! @a p must be unreachable for new readers already.
+		template<class T>
+		void retire(T *p)
+		{
+			retire(p, &detail::_retire_traits<T>::default_delete);
+		}
+
+		//! Call <tt>deleter(p)</tt> once no hazard pointer holds @a p.
+		template<class T>
+		void retire(T *p, void(*deleter)(T*))
+		{
+			_retire(detail::_retire_traits<T>::make(p, deleter));
+		}
+
+		//! Delete what the calling thread (or a thread that has exited) has
+		//! retired and is not protected.
+		void collect();
+
+	private:
+		atomic<record*> _records;         //!< All records, never removed before destruction.
+		std::size_t _threshold;
+		thread_specific_ptr<record> _local;
+
+		record& _acquire();
+		void _retire(const detail::_retired &r);
+		void _scan(record &r);
+
+		static void _release(record *r);
+
+		hazard_domain(const hazard_domain&) DELETED_FUNCTION;
+		hazard_domain& operator=(const hazard_domain&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_RECLAMATION_H
@@ -0,0 +1,185 @@
+#ifndef _STDEX_SEMAPHORE_H
+#define _STDEX_SEMAPHORE_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./atomic"
+#include "./chrono"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+#include <climits>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Counting semaphore class.
+	//! Holds a count of permits: @c acquire() takes one, blocking while there
+	//! are none, @c release() returns them. The count lives in a futex word
+	//! next to a count of sleeping threads, so both operations are a single
+	//! atomic instruction while nobody has to sleep; @c release() makes a
+	//! system call only if a thread sleeps. Example usage:
+	//! @code
+	//! counting_semaphore<> items(0);
+	//!
+	//! // producer
+	//! queue.push(item);
+	//! items.release();
+	//!
+	//! // consumer
+	//! items.acquire();
+	//! queue.pop(item);
+	//! @endcode
+	//! @tparam _LeastMaxValue Maximal count the semaphore has to support, at
+	//! most @c INT_MAX: the count is an @c int futex word.
+	template<std::ptrdiff_t _LeastMaxValue = INT_MAX>
+	class counting_semaphore
+	{
+		STATIC_ASSERT(_LeastMaxValue >= 0 && _LeastMaxValue <= INT_MAX, counting_semaphore_max_must_fit_in_int);
+
+	public:
+		//! Maximal count supported.
+		static std::ptrdiff_t (max)() NOEXCEPT_FUNCTION
+		{
+			return _LeastMaxValue;
+		}
+
+		//! Constructor.
+		//! @param[in] desired Initial count.
+		explicit counting_semaphore(std::ptrdiff_t desired) NOEXCEPT_FUNCTION:
+			_count(static_cast<int>(desired)),
+			_waiters(0)
+		{}
+
+		//! Destructor.
+		~counting_semaphore() NOEXCEPT_FUNCTION
+		{}
+
+		//! Increment the count by @a update and wake that many waiting threads.
+		void release(std::ptrdiff_t update = 1) NOEXCEPT_FUNCTION
+		{
+			_count.fetch_add(static_cast<int>(update), memory_order_release);
+
+			// pairs with the fence in _wait(): either the waiter sees the new
+			// count or we see the waiter
+			atomic_thread_fence(memory_order_seq_cst);
+
+			if (_waiters.load(memory_order_relaxed) != 0)
+				detail::futex_wake(_count, update < INT_MAX ? static_cast<int>(update) : INT_MAX);
+		}
+
+		//! Decrement the count, blocking while it is zero.
+		void acquire() NOEXCEPT_FUNCTION
+		{
+			while (!try_acquire())
+				_wait();
+		}
+
+		//! Decrement the count if it is greater than zero.
+		//! @return @c true if the count was decremented.
+		bool try_acquire() NOEXCEPT_FUNCTION
+		{
+			int count = _count.load(memory_order_relaxed);
+
+			while (count > 0)
+			{
+				if (_count.compare_exchange_weak(count, count - 1, memory_order_acquire, memory_order_relaxed))
+					return true;
+			}
+
+			return false;
+		}
+
+		//! Decrement the count, blocking while it is zero for at most @a rtime.
+		//! @return @c true if the count was decremented.
+		template<class _Rep, class _Period>
+		bool try_acquire_for(const chrono::duration<_Rep, _Period> &rtime)
+		{
+			return try_acquire_until(chrono::steady_clock::now() + rtime);
+		}
+
+		//! Decrement the count, blocking while it is zero until @a atime.
+		//! @return @c true if the count was decremented.
+		template<class _Duration>
+		bool try_acquire_until(const chrono::time_point<chrono::steady_clock, _Duration> &atime)
+		{
+			chrono::steady_clock::time_point deadline =
+				chrono::time_point_cast<chrono::steady_clock::duration>(atime);
+
+			while (!try_acquire())
+			{
+				if (!_wait_until(deadline))
+					return try_acquire();
+			}
+
+			return true;
+		}
+
+		template<class _Clock, class _Duration>
+		bool try_acquire_until(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			// DR 887 - Sync unknown clock to known clock.
+			while (!try_acquire_until(chrono::steady_clock::now() + (atime - _Clock::now())))
+			{
+				if (!(_Clock::now() < atime))
+					return false;
+			}
+
+			return true;
+		}
+
+	private:
+		atomic<int> _count;   //!< Futex word.
+		atomic<int> _waiters; //!< Threads sleeping or about to sleep on _count.
+
+		void _wait() NOEXCEPT_FUNCTION
+		{
+			_waiters.fetch_add(1, memory_order_relaxed);
+			atomic_thread_fence(memory_order_seq_cst);
+
+			detail::futex_wait(_count, 0);
+
+			_waiters.fetch_sub(1, memory_order_relaxed);
+		}
+
+		bool _wait_until(const chrono::steady_clock::time_point &deadline) NOEXCEPT_FUNCTION
+		{
+			_waiters.fetch_add(1, memory_order_relaxed);
+			atomic_thread_fence(memory_order_seq_cst);
+
+			bool in_time = detail::futex_wait_until(_count, 0, deadline);
+
+			_waiters.fetch_sub(1, memory_order_relaxed);
+
+			return in_time;
+		}
+
+		counting_semaphore(const counting_semaphore&) DELETED_FUNCTION;
+		counting_semaphore& operator=(const counting_semaphore&) DELETED_FUNCTION;
+	};
+
+	//! Semaphore with a count of at most 1: a lightweight event that one
+	//! thread signals with @c release() and another waits for with
+	//! @c acquire().
+	typedef counting_semaphore<1> binary_semaphore;
+} // namespace stdex
+
+#endif // _STDEX_SEMAPHORE_H
@@ -0,0 +1,503 @@
+#ifndef _STDEX_SHARED_MUTEX_H
+#define _STDEX_SHARED_MUTEX_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./chrono"
+
+// POSIX includes
+#include <pthread>
+
+// std includes
+#include <algorithm>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Whom a shared mutex lets in first when both readers and writers wait.
+	enum shared_mutex_preference
+	{
+		prefer_readers, //!< New readers join readers holding the lock even if writers wait (may starve writers).
+		prefer_writers  //!< A waiting writer blocks new readers.
+	};
+
+	class shared_mutex_base
+	{
+	protected:
+		pthread_rwlock_t _rwlock_handle;
+
+		explicit shared_mutex_base(shared_mutex_preference pref)
+		{
+			// XXX EAGAIN, ENOMEM, EPERM, EBUSY(may), EINVAL(may)
+			pthread_rwlockattr_t attr;
+			pthread_rwlockattr_init(&attr);
+
+#ifdef __GLIBC__
+			// glibc prefers readers by default, other implementations (f.e.
+			// pthreads-win32) are writer-preferring by design
+			if (pref == prefer_writers)
+				pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#else
+			(void) pref;
+#endif
+
+			pthread_rwlock_init(&_rwlock_handle, &attr);
+			pthread_rwlockattr_destroy(&attr);
+		}
+
+		~shared_mutex_base()
+		{
+			pthread_rwlock_destroy(&_rwlock_handle);
+		}
+
+		void _lock(bool shared)
+		{
+			int e = shared ? pthread_rwlock_rdlock(&_rwlock_handle) : pthread_rwlock_wrlock(&_rwlock_handle);
+
+			// EINVAL, EAGAIN(max readers), EDEADLK(may)
+			if (e)
+				throw system_error(errc(e));
+		}
+
+		bool _try_lock(bool shared)
+		{
+			// XXX EINVAL, EAGAIN, EBUSY
+			return ((shared ? pthread_rwlock_tryrdlock(&_rwlock_handle) : pthread_rwlock_trywrlock(&_rwlock_handle)) == 0);
+		}
+
+		void _unlock()
+		{
+			pthread_rwlock_unlock(&_rwlock_handle);
+		}
+
+		template<class _Duration>
+		bool _try_lock_until(bool shared, const chrono::time_point<chrono::steady_clock, _Duration> &atime)
+		{
+#ifdef _STDEX_HAS_PTHREAD_CLOCKLOCK
+			timespec ts = detail::_to_timespec(atime);
+
+			return _timedlock_result(shared ? 
+				pthread_rwlock_clockrdlock(&_rwlock_handle, CLOCK_MONOTONIC, &ts) :
+				pthread_rwlock_clockwrlock(&_rwlock_handle, CLOCK_MONOTONIC, &ts));
+#else
+			// no clock selection for rwlocks: wait on the system clock and
+			// re-check so that a clock step can only cause a spurious retry
+			chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+			while (now < atime)
+			{
+				if (_try_lock_until(shared, chrono::system_clock::now() + (atime - now)))
+					return true;
+				now = chrono::steady_clock::now();
+			}
+
+			return _try_lock(shared);
+#endif
+		}
+
+		template<class _Duration>
+		bool _try_lock_until(bool shared, const chrono::time_point<chrono::system_clock, _Duration> &atime)
+		{
+			timespec ts = detail::_to_timespec(atime);
+
+			return _timedlock_result(shared ?
+				pthread_rwlock_timedrdlock(&_rwlock_handle, &ts) :
+				pthread_rwlock_timedwrlock(&_rwlock_handle, &ts));
+		}
+
+		template<class _Clock, class _Duration>
+		bool _try_lock_until(bool shared, const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			// DR 887 - Sync unknown clock to known clock. _Clock may run at
+			// another rate so check it again after every timeout.
+			typename _Clock::time_point now = _Clock::now();
+
+			do
+			{
+				if (_try_lock_until(shared, chrono::steady_clock::now() + (atime - now)))
+					return true;
+				now = _Clock::now();
+			} while (now < atime);
+
+			return false;
+		}
+
+	private:
+		static bool _timedlock_result(int e)
+		{
+			if (e == 0)
+				return true;
+
+			// EINVAL, EAGAIN(max readers), EDEADLK(may)
+			if (e != ETIMEDOUT)
+				throw system_error(errc(e));
+
+			return false;
+		}
+
+		shared_mutex_base(const shared_mutex_base&) DELETED_FUNCTION;
+		shared_mutex_base& operator=(const shared_mutex_base&) DELETED_FUNCTION;
+	};
+
+	//! Shared mutex class.
+	//! Reader/writer lock: any number of threads may hold it in shared mode
+	//! (@c lock_shared()) at the same time, while exclusive ownership
+	//! (@c lock()) excludes all other owners. Meant for read-mostly data.
+	//! @see shared_lock
+	//! @see shared_timed_mutex
+	class shared_mutex:
+		private shared_mutex_base
+	{
+	public:
+		typedef pthread_rwlock_t* native_handle_type;
+
+		//! Constructor.
+		//! @param[in] pref Whether waiting writers block new readers. Use
+		//! @c prefer_writers when a steady stream of readers could starve writers.
+		explicit shared_mutex(shared_mutex_preference pref = prefer_readers):
+			shared_mutex_base(pref)
+		{}
+
+		//! Destructor.
+		~shared_mutex()
+		{}
+
+		//! Lock the mutex exclusively.
+		//! @throws system_error
+		inline void lock()
+		{
+			_lock(false);
+		}
+
+		//! Try to lock the mutex exclusively without blocking.
+		//! @return @c true if the lock was acquired.
+		inline bool try_lock()
+		{
+			return _try_lock(false);
+		}
+
+		//! Release exclusive ownership.
+		inline void unlock()
+		{
+			_unlock();
+		}
+
+		//! Lock the mutex in shared mode.
+		//! @throws system_error
+		inline void lock_shared()
+		{
+			_lock(true);
+		}
+
+		//! Try to lock the mutex in shared mode without blocking.
+		//! @return @c true if the lock was acquired.
+		inline bool try_lock_shared()
+		{
+			return _try_lock(true);
+		}
+
+		//! Release shared ownership.
+		inline void unlock_shared()
+		{
+			_unlock();
+		}
+
+		native_handle_type native_handle() NOEXCEPT_FUNCTION
+		{
+			return &_rwlock_handle;
+		}
+
+	private:
+		shared_mutex(const shared_mutex&) DELETED_FUNCTION;
+		shared_mutex& operator=(const shared_mutex&) DELETED_FUNCTION;
+	};
+
+	//! Shared timed mutex class.
+	//! Shared mutex that additionally lets the calling thread give up waiting
+	//! for exclusive or shared ownership after a timeout or at a deadline.
+	//! @see shared_mutex
+	class shared_timed_mutex:
+		private shared_mutex_base
+	{
+	public:
+		typedef pthread_rwlock_t* native_handle_type;
+
+		//! Constructor.
+		//! @param[in] pref Whether waiting writers block new readers.
+		explicit shared_timed_mutex(shared_mutex_preference pref = prefer_readers):
+			shared_mutex_base(pref)
+		{}
+
+		//! Destructor.
+		~shared_timed_mutex()
+		{}
+
+		//! Lock the mutex exclusively.
+		//! @throws system_error
+		inline void lock()
+		{
+			_lock(false);
+		}
+
+		//! Try to lock the mutex exclusively without blocking.
+		//! @return @c true if the lock was acquired.
+		inline bool try_lock()
+		{
+			return _try_lock(false);
+		}
+
+		//! Try to lock the mutex exclusively, blocking for at most @a rtime.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		template<class _Rep, class _Period>
+		inline bool try_lock_for(const chrono::duration<_Rep, _Period> &rtime)
+		{
+			return _try_lock_until(false, chrono::steady_clock::now() + rtime);
+		}
+
+		//! Try to lock the mutex exclusively, blocking until @a atime at the latest.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		template<class _Clock, class _Duration>
+		inline bool try_lock_until(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			return _try_lock_until(false, atime);
+		}
+
+		//! Release exclusive ownership.
+		inline void unlock()
+		{
+			_unlock();
+		}
+
+		//! Lock the mutex in shared mode.
+		//! @throws system_error
+		inline void lock_shared()
+		{
+			_lock(true);
+		}
+
+		//! Try to lock the mutex in shared mode without blocking.
+		//! @return @c true if the lock was acquired.
+		inline bool try_lock_shared()
+		{
+			return _try_lock(true);
+		}
+
+		//! Try to lock the mutex in shared mode, blocking for at most @a rtime.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		template<class _Rep, class _Period>
+		inline bool try_lock_shared_for(const chrono::duration<_Rep, _Period> &rtime)
+		{
+			return _try_lock_until(true, chrono::steady_clock::now() + rtime);
+		}
+
+		//! Try to lock the mutex in shared mode, blocking until @a atime at the latest.
+		//! @return @c true if the lock was acquired, or @c false on timeout.
+		template<class _Clock, class _Duration>
+		inline bool try_lock_shared_until(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			return _try_lock_until(true, atime);
+		}
+
+		//! Release shared ownership.
+		inline void unlock_shared()
+		{
+			_unlock();
+		}
+
+		native_handle_type native_handle() NOEXCEPT_FUNCTION
+		{
+			return &_rwlock_handle;
+		}
+
+	private:
+		shared_timed_mutex(const shared_timed_mutex&) DELETED_FUNCTION;
+		shared_timed_mutex& operator=(const shared_timed_mutex&) DELETED_FUNCTION;
+	};
+
+	/** @brief A scoped lock type for shared ownership.
+	*
+	* A shared_lock controls shared ownership of a mutex within a scope the
+	* same way unique_lock controls exclusive ownership: ownership can be
+	* delayed until after construction and is released by the destructor.
+	*/
+	template<class T>
+	class shared_lock
+	{
+	public:
+		typedef T mutex_type;
+
+		shared_lock() NOEXCEPT_FUNCTION :
+			_device(0),
+			_owns(false)
+		{ }
+
+		explicit shared_lock(mutex_type &m):
+			_device(&(m)),
+			_owns(false)
+		{
+			lock();
+			_owns = true;
+		}
+
+		shared_lock(mutex_type &m, defer_lock_t) NOEXCEPT_FUNCTION:
+			_device(&(m)),
+			_owns(false)
+		{ }
+
+		shared_lock(mutex_type &m, try_to_lock_t):
+			_device(&(m)),
+			_owns(_device->try_lock_shared())
+		{ }
+
+		shared_lock(mutex_type &m, adopt_lock_t) NOEXCEPT_FUNCTION:
+			_device(&(m)),
+			_owns(true)
+		{
+			// XXX calling thread owns mutex in shared mode
+		}
+
+		template<class _Clock, class _Duration>
+		shared_lock(mutex_type &m, const chrono::time_point<_Clock, _Duration> &atime):
+			_device(&(m)),
+			_owns(_device->try_lock_shared_until(atime))
+		{ }
+
+		template<class _Rep, class _Period>
+		shared_lock(mutex_type &m, const chrono::duration<_Rep, _Period> &rtime):
+			_device(&(m)),
+			_owns(_device->try_lock_shared_for(rtime))
+		{ }
+
+		~shared_lock()
+		{
+			if (_owns)
+				unlock();
+		}
+
+		void lock()
+		{
+			if (!_device)
+				throw system_error(operation_not_permitted);
+			else if (_owns)
+				throw system_error(resource_deadlock_would_occur);
+			else
+			{
+				_device->lock_shared();
+				_owns = true;
+			}
+		}
+
+		bool try_lock()
+		{
+			if (!_device)
+				throw system_error(operation_not_permitted);
+			else if (_owns)
+				throw system_error(resource_deadlock_would_occur);
+			else
+			{
+				_owns = _device->try_lock_shared();
+				return _owns;
+			}
+		}
+
+		template<typename _Clock, typename _Duration>
+		bool try_lock_until(const chrono::time_point<_Clock, _Duration> &atime)
+		{
+			if (!_device)
+				throw system_error(operation_not_permitted);
+			else if (_owns)
+				throw system_error(resource_deadlock_would_occur);
+			else
+			{
+				_owns = _device->try_lock_shared_until(atime);
+				return _owns;
+			}
+		}
+
+		template<typename _Rep, typename _Period>
+		bool try_lock_for(const chrono::duration<_Rep, _Period> &rtime)
+		{
+			if (!_device)
+				throw system_error(operation_not_permitted);
+			else if (_owns)
+				throw system_error(resource_deadlock_would_occur);
+			else
+			{
+				_owns = _device->try_lock_shared_for(rtime);
+				return _owns;
+			}
+		}
+
+		void unlock()
+		{
+			if (!_owns)
+				throw system_error(operation_not_permitted);
+			else if (_device)
+			{
+				_device->unlock_shared();
+				_owns = false;
+			}
+		}
+
+		void swap(shared_lock &other) NOEXCEPT_FUNCTION
+		{
+			std::swap(_device, other._device);
+			std::swap(_owns, other._owns);
+		}
+
+		mutex_type* release() NOEXCEPT_FUNCTION
+		{
+			mutex_type *ret = _device;
+			_device = 0;
+			_owns = false;
+			return ret;
+		}
+
+		bool owns_lock() const NOEXCEPT_FUNCTION
+		{
+			return _owns;
+		}
+
+		operator bool() const NOEXCEPT_FUNCTION
+		{
+			return owns_lock();
+		}
+
+		mutex_type* mutex() const NOEXCEPT_FUNCTION
+		{
+			return _device;
+		}
+
+	private:
+		mutex_type *_device;
+		bool _owns;
+
+		shared_lock(const shared_lock&) DELETED_FUNCTION;
+		shared_lock& operator=(const shared_lock&) DELETED_FUNCTION;
+	};
+
+	/// Swap overload for shared_lock objects.
+	template<typename _Mutex>
+	inline void swap(shared_lock<_Mutex> &lhs, shared_lock<_Mutex> &rhs) NOEXCEPT_FUNCTION
+	{
+		lhs.swap(rhs);
+	}
+
+} // namespace stdex
+
+#endif // _STDEX_SHARED_MUTEX_H
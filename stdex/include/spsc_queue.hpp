@@ -0,0 +1,404 @@
+#ifndef _STDEX_SPSC_QUEUE_H
+#define _STDEX_SPSC_QUEUE_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./mutex"
+#include "./thread"
+#include "./atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+#include <new>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw()
+
+#else
+
+#define DELETED_FUNCTION
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Bounded single-producer/single-consumer queue.
+	//! A ring buffer for handing elements from exactly one thread to exactly
+	//! one other. The producer owns the write index and the consumer the
+	//! read index, each on its own cache line, and each side keeps a cached
+	//! copy of the other's index so it touches the other's cache line only
+	//! when the cached copy says the ring is full (or empty). The @c try_
+	//! functions, the bulk functions and @c reserve() / @c commit() never
+	//! wait. Example usage:
+	//! @code
+	//! spsc_queue<message> hop(4096);
+	//!
+	//! // producer thread
+	//! new (hop.reserve_wait()) message(...);
+	//! hop.commit();
+	//!
+	//! // consumer thread
+	//! message batch[64];
+	//! std::size_t n = hop.pop_n(batch, 64);
+	//! @endcode
+	//! The blocking @c push() and @c pop() spin briefly, then yield the
+	//! processor; a queue constructed with @c blocking sleeps on a futex
+	//! instead. Sleeping is opt-in because waking a sleeper takes a fence
+	//! after every operation that frees or fills slots, which about halves
+	//! the throughput of single-element handoffs; the bulk functions pay it
+	//! once per call.
+	//! @note @c _Tp has to be copy constructible; slots are raw storage and
+	//! elements are destroyed when popped.
+	template<class _Tp>
+	class spsc_queue
+	{
+	public:
+		typedef _Tp value_type;
+
+		//! Constructor.
+		//! @param[in] capacity Maximal number of elements, rounded up to a
+		//! power of 2 (at least 2).
+		//! @param[in] blocking Let @c push() and @c pop() sleep on a futex
+		//! instead of yielding while the queue is full or empty; for
+		//! consumers that may idle for long.
+		//! @param[in] spin_count Number of retries of the blocking functions
+		//! before they sleep (or yield).
+		explicit spsc_queue(std::size_t capacity, bool blocking = false, unsigned spin_count = 100):
+			_buffer(0),
+			_mask(0),
+			_blocking(blocking),
+			_spin_count(spin_count)
+		{
+			std::size_t size = 2;
+
+			while (size < capacity)
+				size <<= 1;
+
+			_buffer = static_cast<_Tp*>(::operator new(size * sizeof(_Tp)));
+			_mask = size - 1;
+
+			_producer.tail.store(0, memory_order_relaxed);
+			_producer.cached_head = 0;
+			_producer.sleeping.store(0, memory_order_relaxed);
+			_consumer.head.store(0, memory_order_relaxed);
+			_consumer.cached_tail = 0;
+			_consumer.sleeping.store(0, memory_order_relaxed);
+		}
+
+		//! Destructor.
+		//! Destroys the elements left in the queue.
+		//! @note Must not be called while other threads use the queue.
+		~spsc_queue()
+		{
+			std::size_t head = _consumer.head.load(memory_order_relaxed);
+			std::size_t tail = _producer.tail.load(memory_order_acquire);
+
+			for (; head != tail; ++head)
+				_slot(head)->~_Tp();
+
+			::operator delete(_buffer);
+		}
+
+		// PRODUCER
+
+		//! Append @a value unless the queue is full.
+		//! @return @c false if the queue is full.
+		bool try_push(const _Tp &value)
+		{
+			if (!_writable(1))
+				return false;
+
+			std::size_t tail = _producer.tail.load(memory_order_relaxed);
+
+			new (_slot(tail)) _Tp(value);
+			_publish(tail + 1);
+
+			return true;
+		}
+
+		//! Append as many as fit of the @a count elements at @a values.
+		//! @return Number of elements appended.
+		std::size_t push_n(const _Tp *values, std::size_t count)
+		{
+			std::size_t n = _writable(count);
+
+			if (n > count)
+				n = count;
+
+			if (!n)
+				return 0;
+
+			std::size_t tail = _producer.tail.load(memory_order_relaxed);
+
+			for (std::size_t i = 0; i < n; ++i)
+				new (_slot(tail + i)) _Tp(values[i]);
+
+			_publish(tail + n);
+
+			return n;
+		}
+
+		//! Append @a value, waiting while the queue is full.
+		void push(const _Tp &value)
+		{
+			while (!try_push(value))
+				_wait_writable();
+		}
+
+		//! Storage of the next element, to construct it in place (with
+		//! placement new) and append it with @c commit().
+		//! @return 0 if the queue is full.
+		void* reserve()
+		{
+			return _writable(1) ? _slot(_producer.tail.load(memory_order_relaxed)) : 0;
+		}
+
+		//! Like @c reserve(), waiting while the queue is full.
+		void* reserve_wait()
+		{
+			while (!_writable(1))
+				_wait_writable();
+
+			return _slot(_producer.tail.load(memory_order_relaxed));
+		}
+
+		//! Append the element constructed in the storage returned by the
+		//! last @c reserve() or @c reserve_wait().
+		void commit()
+		{
+			_publish(_producer.tail.load(memory_order_relaxed) + 1);
+		}
+
+		// CONSUMER
+
+		//! Remove the first element and store it in @a value unless the queue
+		//! is empty.
+		//! @return @c false if the queue is empty.
+		bool try_pop(_Tp &value)
+		{
+			if (!_readable(1))
+				return false;
+
+			std::size_t head = _consumer.head.load(memory_order_relaxed);
+			_Tp *p = _slot(head);
+
+			value = *p;
+			p->~_Tp();
+			_release(head + 1);
+
+			return true;
+		}
+
+		//! Remove up to @a count elements and store them at @a values.
+		//! @return Number of elements removed.
+		std::size_t pop_n(_Tp *values, std::size_t count)
+		{
+			std::size_t n = _readable(count);
+
+			if (n > count)
+				n = count;
+
+			if (!n)
+				return 0;
+
+			std::size_t head = _consumer.head.load(memory_order_relaxed);
+
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				_Tp *p = _slot(head + i);
+
+				values[i] = *p;
+				p->~_Tp();
+			}
+
+			_release(head + n);
+
+			return n;
+		}
+
+		//! Remove the first element and store it in @a value, waiting while
+		//! the queue is empty.
+		void pop(_Tp &value)
+		{
+			while (!try_pop(value))
+				_wait_readable();
+		}
+
+		//! First element, to use it in place; @c pop_front() removes it.
+		//! @return 0 if the queue is empty.
+		_Tp* front()
+		{
+			return _readable(1) ? _slot(_consumer.head.load(memory_order_relaxed)) : 0;
+		}
+
+		//! Like @c front(), waiting while the queue is empty.
+		_Tp* front_wait()
+		{
+			while (!_readable(1))
+				_wait_readable();
+
+			return _slot(_consumer.head.load(memory_order_relaxed));
+		}
+
+		//! Destroy and remove the first element; the queue must not be empty.
+		void pop_front()
+		{
+			std::size_t head = _consumer.head.load(memory_order_relaxed);
+
+			_slot(head)->~_Tp();
+			_release(head + 1);
+		}
+
+		//! Maximal number of elements.
+		std::size_t capacity() const NOEXCEPT_FUNCTION
+		{
+			return _mask + 1;
+		}
+
+	private:
+		struct producer_side
+		{
+			atomic<std::size_t> tail;        // next slot to write
+			std::size_t cached_head;         // last head seen, head <= cached_head
+			atomic<int> sleeping;            // futex word, 1 while the producer waits
+		};
+
+		struct consumer_side
+		{
+			atomic<std::size_t> head;        // next slot to read
+			std::size_t cached_tail;         // last tail seen, cached_tail <= tail
+			atomic<int> sleeping;            // futex word, 1 while the consumer waits
+		};
+
+		// Read-only after construction, then one cache line per side.
+		char _pad0[_STDEX_CACHE_LINE_SIZE];
+		_Tp *_buffer;
+		std::size_t _mask;
+		bool _blocking;
+		unsigned _spin_count;
+		char _pad1[_STDEX_CACHE_LINE_SIZE];
+		producer_side _producer;
+		char _pad2[_STDEX_CACHE_LINE_SIZE - sizeof(producer_side) % _STDEX_CACHE_LINE_SIZE];
+		consumer_side _consumer;
+		char _pad3[_STDEX_CACHE_LINE_SIZE - sizeof(consumer_side) % _STDEX_CACHE_LINE_SIZE];
+
+		_Tp* _slot(std::size_t index) const NOEXCEPT_FUNCTION
+		{
+			return _buffer + (index & _mask);
+		}
+
+		// Free slots, counting on the cached head while it shows at least want.
+		std::size_t _writable(std::size_t want)
+		{
+			std::size_t tail = _producer.tail.load(memory_order_relaxed);
+			std::size_t free = capacity() - (tail - _producer.cached_head);
+
+			if (free < want)
+			{
+				_producer.cached_head = _consumer.head.load(memory_order_acquire);
+				free = capacity() - (tail - _producer.cached_head);
+			}
+
+			return free;
+		}
+
+		// Filled slots, counting on the cached tail while it shows at least want.
+		std::size_t _readable(std::size_t want)
+		{
+			std::size_t head = _consumer.head.load(memory_order_relaxed);
+			std::size_t filled = _consumer.cached_tail - head;
+
+			if (filled < want)
+			{
+				_consumer.cached_tail = _producer.tail.load(memory_order_acquire);
+				filled = _consumer.cached_tail - head;
+			}
+
+			return filled;
+		}
+
+		void _publish(std::size_t tail)
+		{
+			_producer.tail.store(tail, memory_order_release);
+
+			if (_blocking)
+				_wake(_consumer.sleeping);
+		}
+
+		void _release(std::size_t head)
+		{
+			_consumer.head.store(head, memory_order_release);
+
+			if (_blocking)
+				_wake(_producer.sleeping);
+		}
+
+		// Pairs with the fence of _sleep(): either the sleeper sees the new
+		// index or we see it sleeping.
+		static void _wake(atomic<int> &sleeping)
+		{
+			atomic_thread_fence(memory_order_seq_cst);
+
+			if (sleeping.load(memory_order_relaxed))
+			{
+				sleeping.store(0, memory_order_relaxed);
+				detail::futex_wake(sleeping, 1);
+			}
+		}
+
+		void _wait_writable()
+		{
+			for (unsigned i = 0; i < _spin_count; ++i)
+			{
+				if (_writable(1))
+					return;
+				detail::cpu_relax();
+			}
+
+			if (!_blocking)
+				this_thread::yield();
+			else
+				_sleep(_producer.sleeping, &spsc_queue::_writable);
+		}
+
+		void _wait_readable()
+		{
+			for (unsigned i = 0; i < _spin_count; ++i)
+			{
+				if (_readable(1))
+					return;
+				detail::cpu_relax();
+			}
+
+			if (!_blocking)
+				this_thread::yield();
+			else
+				_sleep(_consumer.sleeping, &spsc_queue::_readable);
+		}
+
+		void _sleep(atomic<int> &sleeping, std::size_t(spsc_queue::*ready)(std::size_t))
+		{
+			sleeping.store(1, memory_order_relaxed);
+			atomic_thread_fence(memory_order_seq_cst);
+
+			if (!(this->*ready)(1))
+				detail::futex_wait(sleeping, 1);
+
+			sleeping.store(0, memory_order_relaxed);
+		}
+
+		spsc_queue(const spsc_queue&) DELETED_FUNCTION;
+		spsc_queue& operator=(const spsc_queue&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_SPSC_QUEUE_H
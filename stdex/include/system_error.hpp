@@ -13,7 +13,8 @@
 
 // std includes
 #include <cerrno>
-#include <cstdlib>		// for std::strerror
+#include <cstdlib>
+#include <cstring>		// for std::strerror
 #include <stdexcept>	// for std::runtime_error
 
 #ifdef _STDEX_HAS_CPP11_SUPPORT
@@ -675,40 +676,6 @@ namespace stdex
 				return (error_condition(_Errval, system_category()));
 		}
 	};
-
-	template<class _Cat>
-	struct _Error_objects
-	{	// wraps category objects
-		_Error_objects()
-		{	// default constructor
-		}
-
-		static _Generic_error_category _Generic_object;
-		static _Iostream_error_category _Iostream_object;
-		static _System_error_category _System_object;
-	};
-
-	template<class _Cat>
-	_Generic_error_category _Error_objects<_Cat>::_Generic_object;
-	template<class _Cat>
-	_Iostream_error_category _Error_objects<_Cat>::_Iostream_object;
-	template<class _Cat>
-	_System_error_category _Error_objects<_Cat>::_System_object;
-
-	inline const error_category& generic_category() NOEXCEPT_FUNCTION
-	{	// get generic_category
-		return (_Error_objects<int>::_Generic_object);
-	}
-
-	inline const error_category& iostream_category() NOEXCEPT_FUNCTION
-	{	// get iostream_category
-		return (_Error_objects<int>::_Iostream_object);
-	}
-
-	inline const error_category& system_category() NOEXCEPT_FUNCTION
-	{	// get system_category
-		return (_Error_objects<int>::_System_object);
-	}
 } // namespace stdex
 
 #endif // _STDEX_SYSTEM_ERROR_H
\ No newline at end of file
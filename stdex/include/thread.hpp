@@ -7,6 +7,7 @@
 
 // stdex includes
 #include "./mutex"
+#include "./atomic"
 #include "./condition_variable"
 #include "./chrono"
 
@@ -16,6 +17,9 @@
 // std includes
 #include <ostream>
 #include <memory>
+#include <cstddef>
+#include <climits> // for CHAR_BIT
+#include <stdexcept>
 
 #ifdef _STDEX_HAS_CPP11_SUPPORT
 
@@ -34,6 +38,9 @@ namespace stdex
 	//! Thread class.
 	class thread {
 
+		// Callables of the member function constructors. They are copied
+		// byte-wise into the start record of the new thread, so they must stay
+		// trivially copyable and destructible.
 		template<class ClassT>
 		struct classfunc
 		{
@@ -51,24 +58,20 @@ namespace stdex
 
 			static void proxy(void *obj)
 			{
-				classfunc &f = *reinterpret_cast<classfunc*>(obj);
-
-				f();
-
-				delete &f;
+				(*reinterpret_cast<classfunc*>(obj))();
 			}
 		};
 
 		template<class ClassT, class DataT>
 		struct classfuncwithdata
 		{
-			typedef void(ClassT::*function_type)(DataT*);
+			typedef void(ClassT::*function_type)(DataT);
 
-			classfuncwithdata(ClassT *obj_, function_type func, DataT *data_) :obj(obj_), func(func_), data(data_) {}
+			classfuncwithdata(ClassT *obj_, function_type func_, DataT data_) :obj(obj_), func(func_), data(data_) {}
 
 			ClassT *obj;
 			function_type func;
-			DataT *data;
+			DataT data;
 
 			inline void operator()()
 			{
@@ -77,47 +80,29 @@ namespace stdex
 
 			static void proxy(void *obj)
 			{
-				classfuncwithdata &f = *reinterpret_cast<classfuncwithdata*>(obj);
-
-				f();
-
-				delete &f;
+				(*reinterpret_cast<classfuncwithdata*>(obj))();
 			}
 		};
 
-		template<class ClassT, class DataT>
-		struct classfuncwithdata<ClassT, DataT*>
-		{
-			typedef void(ClassT::*function_type)(DataT*);
-
-			classfuncwithdata(ClassT *obj_, function_type func, DataT *data_) :obj(obj_), func(func_), data(data_) {}
-
-			ClassT *obj;
-			function_type func;
-			DataT *data;
-
-			static void proxy(void *obj)
-			{
-				classfuncwithdata *d = reinterpret_cast<classfuncwithdata*>(obj);
-
-				d->(*func)(data);
-
-				delete d;
-			}
-		};
-
-		void init(void(*aFunction)(void *), void * aArg);
-
 	public:
 		typedef pthread_t native_handle_type;
 
 		class id;
+		class cpu_mask;
+		class attributes;
 
+	private:
+		// Start a thread running aFunction. If aArgSize is not 0, aArg points to
+		// a callable of that size which is copied into the start record, and
+		// the copy is what aFunction gets.
+		void init(void(*aFunction)(void *), void * aArg, const attributes *attr = 0, std::size_t aArgSize = 0);
+
+	public:
 		//! Default constructor.
 		//! Construct a @c thread object without an associated thread of execution
 		//! (i.e. non-joinable).
 		thread() NOEXCEPT_FUNCTION: 
-			_not_a_thread(true)
+			_thread_info(0)
 		{
 		}
 
@@ -129,20 +114,50 @@ namespace stdex
 		//! @note This constructor is not fully compatible with the standard C++
 		//! thread class. It is more similar to the pthread_create() (POSIX) and
 		//! CreateThread() (Windows) functions.
+		//! @throws system_error if the thread can't be created.
 		thread(void(*aFunction)(void *), void * aArg);
 
 		template<class ClassT>
 		thread(void(ClassT::*aFunction)(void), ClassT *obj) :
-			_not_a_thread(true)
+			_thread_info(0)
 		{
-			init(&classfunc<ClassT>::proxy, new classfunc<ClassT>(obj, aFunction));
+			classfunc<ClassT> f(obj, aFunction);
+			init(&classfunc<ClassT>::proxy, &f, 0, sizeof(f));
 		}
 
 		template<class ClassT, class DataT>
 		thread(void(ClassT::*aFunction)(DataT*), ClassT *obj, DataT *aArg) :
-			_not_a_thread(true)
+			_thread_info(0)
+		{
+			classfuncwithdata<ClassT, DataT*> f(obj, aFunction, aArg);
+			init(&classfuncwithdata<ClassT, DataT*>::proxy, &f, 0, sizeof(f));
+		}
+
+		//! Thread starting constructors with creation attributes.
+		//! Same as the constructors above, the new thread is created with the
+		//! stack, affinity, scheduling and name given in @a attr.
+		//! Example usage:
+		//! @code
+		//! thread t(thread::attributes().stack_size(64 * 1024).name("worker"), &work, arg);
+		//! @endcode
+		//! @throws system_error if the attributes can't be applied or the
+		//! thread can't be created.
+		thread(const attributes &attr, void(*aFunction)(void *), void * aArg);
+
+		template<class ClassT>
+		thread(const attributes &attr, void(ClassT::*aFunction)(void), ClassT *obj) :
+			_thread_info(0)
+		{
+			classfunc<ClassT> f(obj, aFunction);
+			init(&classfunc<ClassT>::proxy, &f, &attr, sizeof(f));
+		}
+
+		template<class ClassT, class DataT>
+		thread(const attributes &attr, void(ClassT::*aFunction)(DataT*), ClassT *obj, DataT *aArg) :
+			_thread_info(0)
 		{
-			init(&classfuncwithdata<ClassT, DataT*>::proxy, new classfuncwithdata<ClassT, DataT*>(obj, aFunction, aArg));
+			classfuncwithdata<ClassT, DataT*> f(obj, aFunction, aArg);
+			init(&classfuncwithdata<ClassT, DataT*>::proxy, &f, &attr, sizeof(f));
 		}
 
 		//! Destructor.
@@ -190,12 +205,14 @@ namespace stdex
 
 	private:
 		native_handle_type _thread_handle;   //!< Thread handle.
-		mutable mutex _data_mutex;     //!< Serializer for access to the thread private data.
-		bool _not_a_thread;			  //!< True if this object is not a thread of execution.
+		unsigned long int _id;			  //!< Thread id value assigned on start.
 
 		struct thread_start_info;
 
-		thread_start_info *_thread_info;
+		//! Start record shared with the thread; null if this object is not a
+		//! thread of execution. Lets joinable() and get_id() get away with a
+		//! load instead of a lock.
+		atomic<thread_start_info*> _thread_info;
 
 		//thread(thread&) DELETED_FUNCTION;
 		thread(const thread&) DELETED_FUNCTION;
@@ -275,6 +292,166 @@ namespace stdex
 		unsigned long int _id;
 	};
 
+	//! Set of processors a thread may run on.
+	//! @see thread::attributes::affinity, this_thread::set_affinity
+	class thread::cpu_mask {
+	public:
+		enum { max_cpus = 1024 }; //!< Number of processors a mask can hold.
+
+		//! Construct an empty mask.
+		cpu_mask() NOEXCEPT_FUNCTION
+		{
+			clear();
+		}
+
+		//! Add processor @a cpu (numbered from 0).
+		//! @throws std::out_of_range if @a cpu >= max_cpus
+		cpu_mask& set(unsigned cpu)
+		{
+			_check(cpu);
+			_bits[cpu / _word_bits] |= 1UL << (cpu % _word_bits);
+			return *this;
+		}
+
+		//! Remove processor @a cpu.
+		//! @throws std::out_of_range if @a cpu >= max_cpus
+		cpu_mask& reset(unsigned cpu)
+		{
+			_check(cpu);
+			_bits[cpu / _word_bits] &= ~(1UL << (cpu % _word_bits));
+			return *this;
+		}
+
+		//! Check if processor @a cpu is in the mask.
+		bool test(unsigned cpu) const NOEXCEPT_FUNCTION
+		{
+			return cpu < max_cpus && (_bits[cpu / _word_bits] & (1UL << (cpu % _word_bits))) != 0;
+		}
+
+		//! Check if the mask is empty.
+		bool none() const NOEXCEPT_FUNCTION
+		{
+			for (std::size_t i = 0; i < _words; ++i)
+				if (_bits[i])
+					return false;
+			return true;
+		}
+
+		//! Remove all processors.
+		void clear() NOEXCEPT_FUNCTION
+		{
+			for (std::size_t i = 0; i < _words; ++i)
+				_bits[i] = 0;
+		}
+
+	private:
+		enum
+		{
+			_word_bits = CHAR_BIT * sizeof(unsigned long),
+			_words = max_cpus / _word_bits
+		};
+
+		unsigned long _bits[_words];
+
+		static void _check(unsigned cpu)
+		{
+			if (cpu >= max_cpus)
+				throw std::out_of_range("thread::cpu_mask: processor number out of range");
+		}
+	};
+
+	//! Thread creation attributes.
+	//! Collects the settings of a new thread; every setter returns the object
+	//! so calls can be chained. Settings that are not given keep the system
+	//! defaults. Example usage:
+	//! @code
+	//! thread::attributes attr;
+	//! attr.stack_size(256 * 1024)
+	//!     .affinity(thread::cpu_mask().set(3))
+	//!     .scheduling(SCHED_FIFO, 10)
+	//!     .name("feed-handler");
+	//!
+	//! thread t(attr, &handle_feed, &feed);
+	//! @endcode
+	class thread::attributes {
+	public:
+		//! Construct attributes with the system defaults.
+		attributes() NOEXCEPT_FUNCTION:
+			_stack_size(0),
+			_guard_size(0),
+			_has_guard_size(false),
+			_has_affinity(false),
+			_has_scheduling(false),
+			_policy(0),
+			_priority(0)
+		{
+			_name[0] = 0;
+		}
+
+		//! Size of the stack of the new thread in bytes (at least
+		//! PTHREAD_STACK_MIN).
+		attributes& stack_size(std::size_t bytes) NOEXCEPT_FUNCTION
+		{
+			_stack_size = bytes;
+			return *this;
+		}
+
+		//! Size of the guard area at the end of the stack in bytes; 0 disables it.
+		attributes& guard_size(std::size_t bytes) NOEXCEPT_FUNCTION
+		{
+			_guard_size = bytes;
+			_has_guard_size = true;
+			return *this;
+		}
+
+		//! Processors the new thread may run on.
+		//! @note Supported with glibc only; elsewhere creating the thread
+		//! throws system_error.
+		attributes& affinity(const cpu_mask &cpus) NOEXCEPT_FUNCTION
+		{
+			_affinity = cpus;
+			_has_affinity = true;
+			return *this;
+		}
+
+		//! Scheduling policy (@c SCHED_OTHER, @c SCHED_FIFO, @c SCHED_RR...)
+		//! and priority of the new thread instead of the ones of the creator.
+		//! @note Real-time policies usually need privileges.
+		attributes& scheduling(int policy, int priority) NOEXCEPT_FUNCTION
+		{
+			_policy = policy;
+			_priority = priority;
+			_has_scheduling = true;
+			return *this;
+		}
+
+		//! Name of the new thread shown by debuggers and system tools;
+		//! truncated to 15 characters.
+		attributes& name(const char *name) NOEXCEPT_FUNCTION
+		{
+			std::size_t i = 0;
+
+			for (; name[i] && i < sizeof(_name) - 1; ++i)
+				_name[i] = name[i];
+			_name[i] = 0;
+
+			return *this;
+		}
+
+	private:
+		friend class thread;
+
+		std::size_t _stack_size;
+		std::size_t _guard_size;
+		bool _has_guard_size;
+		bool _has_affinity;
+		bool _has_scheduling;
+		int _policy;
+		int _priority;
+		cpu_mask _affinity;
+		char _name[16];
+	};
+
 	inline void swap(thread &rhs, thread &lhs) NOEXCEPT_FUNCTION
 	{
 		rhs.swap(lhs);
@@ -283,6 +460,11 @@ namespace stdex
 	namespace detail
 	{
 		void sleep_for_impl(const struct timespec *reltime);
+
+		// Sleep until the steady (CLOCK_MONOTONIC) or the system
+		// (CLOCK_REALTIME) clock reaches abstime.
+		void sleep_until_steady_impl(const struct timespec *abstime);
+		void sleep_until_system_impl(const struct timespec *abstime);
 	}
 
 	//! The namespace @c this_thread provides methods for dealing with the
@@ -301,6 +483,20 @@ namespace stdex
 		}
 
 
+		//! Restrict the calling thread to the processors in @a cpus.
+		//! @throws system_error on failure or if the platform can't do it
+		//! (supported with glibc only).
+		void set_affinity(const thread::cpu_mask &cpus);
+
+		//! Change the scheduling policy and priority of the calling thread.
+		//! @throws system_error on failure.
+		//! @see thread::attributes::scheduling
+		void set_scheduling(int policy, int priority);
+
+		//! Change the name of the calling thread shown by debuggers and system
+		//! tools (truncated to 15 characters). Ignored where not supported.
+		void set_name(const char *name) NOEXCEPT_FUNCTION;
+
 		//! Blocks the calling thread for a period of time.
 		//! @param[in] aTime Minimum time to put the thread to sleep.
 		//! Example usage:
@@ -324,6 +520,12 @@ namespace stdex
 			detail::sleep_for_impl(&ts);
 		}
 
+		//! Blocks the calling thread until a point in time.
+		//! @param[in] t Time point to sleep until.
+		//! Deadlines on the steady and the system clock are handed to the
+		//! kernel as absolute times (clock_nanosleep with TIMER_ABSTIME where
+		//! available), so neither the time spent computing the remaining
+		//! duration nor changes of the system time make the thread oversleep.
 		template <class _Clock, class _Duration>
 		inline void sleep_until(const chrono::time_point<_Clock, _Duration> &t)
 		{
@@ -343,6 +545,74 @@ namespace stdex
 			}
 
 		}
+
+		template <class _Duration>
+		inline void sleep_until(const chrono::time_point<chrono::steady_clock, _Duration> &t)
+		{
+			timespec ts = detail::_to_timespec(t);
+
+			detail::sleep_until_steady_impl(&ts);
+		}
+
+		template <class _Duration>
+		inline void sleep_until(const chrono::time_point<chrono::system_clock, _Duration> &t)
+		{
+			timespec ts = detail::_to_timespec(t);
+
+			detail::sleep_until_system_impl(&ts);
+		}
+
+		//! Tuning of precise_sleep_until().
+		//! The kernel wakes sleeping threads late by up to the timer slack of
+		//! the thread (50 us by default on Linux) plus the scheduling latency.
+		//! A precise sleep therefore sleeps in the kernel only until
+		//! @c yield_margin before the deadline, then yields the processor in a
+		//! loop until @c spin_margin before it and spins for the rest.
+		struct precise_sleep_policy
+		{
+			chrono::nanoseconds yield_margin; //!< Time before the deadline to stop sleeping in the kernel.
+			chrono::nanoseconds spin_margin;  //!< Time before the deadline to stop yielding.
+
+			precise_sleep_policy():
+				yield_margin(chrono::microseconds(100)),
+				spin_margin(chrono::microseconds(10))
+			{}
+
+			precise_sleep_policy(const chrono::nanoseconds &yield_margin_, const chrono::nanoseconds &spin_margin_):
+				yield_margin(yield_margin_),
+				spin_margin(spin_margin_)
+			{}
+		};
+
+		//! Blocks the calling thread until @a t, waking up as close to @a t as
+		//! possible at the price of processor time.
+		//! Meant for pacing loops that sleep for tens or hundreds of
+		//! microseconds, where the overshoot of sleep_until() is as long as
+		//! the sleep itself.
+		//! @see precise_sleep_policy
+		void precise_sleep_until(const chrono::steady_clock::time_point &t,
+			const precise_sleep_policy &policy = precise_sleep_policy());
+
+		//! Blocks the calling thread for @a d, waking up as close to the end
+		//! as possible.
+		//! Example usage:
+		//! @code
+		//! // Send a packet every 50 microseconds
+		//! chrono::steady_clock::time_point next = chrono::steady_clock::now();
+		//! for (;;)
+		//! {
+		//!   send_packet();
+		//!   next += chrono::microseconds(50);
+		//!   this_thread::precise_sleep_until(next);
+		//! }
+		//! @endcode
+		//! @see precise_sleep_until
+		template <class _Rep, class _Period>
+		inline void precise_sleep_for(const chrono::duration<_Rep, _Period> &d,
+			const precise_sleep_policy &policy = precise_sleep_policy())
+		{
+			precise_sleep_until(chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(d), policy);
+		}
 	}
 } // namespace stdex
 
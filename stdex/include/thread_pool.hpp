@@ -0,0 +1,194 @@
+#ifndef _STDEX_THREAD_POOL_H
+#define _STDEX_THREAD_POOL_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./thread"
+#include "./mutex"
+#include "./condition_variable"
+#include "./atomic"
+
+// POSIX includes
+/*none*/
+
+// std includes
+/*none*/
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw() 
+
+#else
+
+#define DELETED_FUNCTION 
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Thread pool class.
+	//! A fixed set of worker threads that execute submitted tasks, so short
+	//! jobs don't pay for a thread creation each. Every worker owns a
+	//! Chase-Lev work-stealing deque: tasks submitted from inside a task go to
+	//! the deque of the submitting worker, tasks submitted from any other
+	//! thread go to a shared queue, and idle workers steal from the others.
+	//! Tasks take the same callable shapes as the @c thread constructors.
+	//! Example usage:
+	//! @code
+	//! thread_pool pool; // one worker per hardware thread
+	//!
+	//! for (int i = 0; i < 1000; ++i)
+	//!   pool.submit(&process_item, &items[i]);
+	//!
+	//! pool.wait(); // all items are processed now
+	//! @endcode
+	class thread_pool
+	{
+		struct task
+		{
+			task *next; //!< Link in the shared submission queue.
+
+			task() : next(0) {}
+			virtual ~task() {}
+
+			virtual void run() = 0;
+		};
+
+		struct function_task:
+			task
+		{
+			typedef void(*function_type)(void *);
+
+			function_task(function_type func_, void *arg_) :func(func_), arg(arg_) {}
+
+			function_type func;
+			void *arg;
+
+			virtual void run()
+			{
+				(*func)(arg);
+			}
+		};
+
+		template<class ClassT>
+		struct classfunc_task:
+			task
+		{
+			typedef void(ClassT::*function_type)(void);
+
+			classfunc_task(ClassT *obj_, function_type func_) :obj(obj_), func(func_) {}
+
+			ClassT *obj;
+			function_type func;
+
+			virtual void run()
+			{
+				(obj->*func)();
+			}
+		};
+
+		template<class ClassT, class DataT>
+		struct classfuncwithdata_task:
+			task
+		{
+			typedef void(ClassT::*function_type)(DataT*);
+
+			classfuncwithdata_task(ClassT *obj_, function_type func_, DataT *data_) :obj(obj_), func(func_), data(data_) {}
+
+			ClassT *obj;
+			function_type func;
+			DataT *data;
+
+			virtual void run()
+			{
+				(obj->*func)(data);
+			}
+		};
+
+		class work_stealing_deque;
+		struct worker;
+
+	public:
+		//! Constructor.
+		//! Starts the worker threads.
+		//! @param[in] threads Number of worker threads; 0 means one per hardware
+		//! thread (@c thread::hardware_concurrency()).
+		//! @throws system_error if a worker thread can't be started; the
+		//! workers already started are stopped first.
+		explicit thread_pool(unsigned threads = 0);
+
+		//! Destructor.
+		//! Runs all tasks submitted so far (including the ones they submit) to
+		//! completion and joins the worker threads.
+		~thread_pool();
+
+		//! Submit a task calling <tt>aFunction(aArg)</tt>.
+		void submit(void(*aFunction)(void *), void *aArg)
+		{
+			_submit(new function_task(aFunction, aArg));
+		}
+
+		//! Submit a task calling <tt>(obj->*aFunction)()</tt>.
+		template<class ClassT>
+		void submit(void(ClassT::*aFunction)(void), ClassT *obj)
+		{
+			_submit(new classfunc_task<ClassT>(obj, aFunction));
+		}
+
+		//! Submit a task calling <tt>(obj->*aFunction)(aArg)</tt>.
+		template<class ClassT, class DataT>
+		void submit(void(ClassT::*aFunction)(DataT*), ClassT *obj, DataT *aArg)
+		{
+			_submit(new classfuncwithdata_task<ClassT, DataT>(obj, aFunction, aArg));
+		}
+
+		//! Block until every task submitted so far has finished.
+		//! @note Must not be called from inside a task of this pool.
+		void wait();
+
+		//! Number of worker threads.
+		unsigned size() const NOEXCEPT_FUNCTION
+		{
+			return _worker_count;
+		}
+
+	private:
+		worker *_workers;
+		unsigned _worker_count;
+
+		mutex _queue_lock;            //!< Serializer for the shared submission queue.
+		task *_queue_head;
+		task *_queue_tail;
+		atomic<long> _queued;         //!< Number of tasks in the shared queue.
+
+		mutex _sleep_lock;
+		condition_variable _wake_up;  //!< Idle workers sleep here.
+		atomic<long> _sleepers;       //!< Number of workers going to sleep or sleeping.
+		bool _stopping;               //!< Guarded by _sleep_lock.
+
+		mutex _done_lock;
+		condition_variable _done;     //!< Signalled when _pending drops to zero.
+		atomic<long> _pending;        //!< Tasks submitted but not finished yet.
+
+		void _submit(task *t);
+		void _wake_one();
+		task* _find_task(worker &w);
+		task* _dequeue_submitted();
+		bool _has_work() const;
+		bool _sleep();
+		void _run(task *t);
+		void _stop(unsigned started);
+
+		static void _worker_main(void *aArg);
+
+		thread_pool(const thread_pool&) DELETED_FUNCTION;
+		thread_pool& operator=(const thread_pool&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_THREAD_POOL_H
@@ -0,0 +1,278 @@
+#ifndef _STDEX_THREAD_SPECIFIC_PTR_H
+#define _STDEX_THREAD_SPECIFIC_PTR_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./core.h"
+#include "./mutex"
+
+// POSIX includes
+#include <pthread>
+
+// std includes
+/*none*/
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw()
+
+#else
+
+#define DELETED_FUNCTION
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Per-thread variable of POD type.
+	//! Every (@a T, @a Tag) pair names one variable with a separate,
+	//! zero-initialized value in each thread. Uses the compiler's thread-local
+	//! storage (@c __thread, @c __declspec(thread)) when there is one, a pthread
+	//! key otherwise. Example usage:
+	//! @code
+	//! struct bytes_sent_tag;
+	//! typedef thread_local_pod<std::size_t, bytes_sent_tag> bytes_sent;
+	//!
+	//! bytes_sent::set(bytes_sent::get() + n);
+	//! @endcode
+	//! @note @a T must be a POD type; values are not destroyed at thread exit.
+	template<class T, class Tag = void>
+	class thread_local_pod
+	{
+	public:
+		//! Value of the calling thread.
+		static T get() NOEXCEPT_FUNCTION
+		{
+#ifdef _STDEX_THREAD_LOCAL
+			return _value;
+#else
+			T *p = static_cast<T*>(pthread_getspecific(_key()));
+			return p ? *p : T();
+#endif
+		}
+
+		//! Change the value of the calling thread.
+		static void set(const T &value)
+		{
+#ifdef _STDEX_THREAD_LOCAL
+			_value = value;
+#else
+			pthread_key_t key = _key();
+			T *p = static_cast<T*>(pthread_getspecific(key));
+
+			if (!p)
+			{
+				p = new T();
+				pthread_setspecific(key, p);
+			}
+
+			*p = value;
+#endif
+		}
+
+	private:
+#ifdef _STDEX_THREAD_LOCAL
+		static _STDEX_THREAD_LOCAL T _value;
+#else
+		static pthread_key_t _key_value;
+		static atomic<int> _key_once;
+
+		static void _destroy(void *p)
+		{
+			delete static_cast<T*>(p);
+		}
+
+		static void _create_key()
+		{
+			pthread_key_create(&_key_value, &_destroy);
+		}
+
+		static pthread_key_t _key()
+		{
+			detail::_call_once(_key_once, &_create_key);
+			return _key_value;
+		}
+#endif
+
+		thread_local_pod() DELETED_FUNCTION;
+	};
+
+#ifdef _STDEX_THREAD_LOCAL
+	template<class T, class Tag>
+	_STDEX_THREAD_LOCAL T thread_local_pod<T, Tag>::_value;
+#else
+	template<class T, class Tag>
+	pthread_key_t thread_local_pod<T, Tag>::_key_value;
+
+	template<class T, class Tag>
+	atomic<int> thread_local_pod<T, Tag>::_key_once; // zero-initialized, see detail::_call_once
+#endif
+
+	namespace detail
+	{
+		// Key of a thread_specific_ptr, referenced by the thread_specific_ptr
+		// and by each node, so a node that outlives its thread_specific_ptr in
+		// another thread can tell and be freed without cleanup.
+		struct _tss_key
+		{
+			pthread_key_t key;
+			atomic<long> refs;
+			atomic<bool> deleted;                // the thread_specific_ptr is gone
+		};
+
+		// Value of a thread_specific_ptr in one thread. The nodes of a thread
+		// are also linked into a per-thread list so a stdex::thread can run
+		// the cleanups itself when its function returns.
+		struct _tss_node
+		{
+			void *value;
+			void(*cleanup)();                    // user cleanup, type-erased
+			void(*invoke)(void(*)(), void*);     // calls cleanup with value
+			_tss_key *owner;
+			unsigned round;                      // of _tss_run_cleanups, cleanup ran in
+			_tss_node *next;
+		};
+
+		// Create a key whose destructor runs the cleanup of the node.
+		_tss_key* _tss_create_key();
+
+		// Delete key; the nodes other threads have for it are freed without
+		// cleanup.
+		void _tss_delete_key(_tss_key *key) NOEXCEPT_FUNCTION;
+
+		// Create the node of the calling thread for key.
+		_tss_node* _tss_attach(_tss_key *key, void(*cleanup)(), void(*invoke)(void(*)(), void*));
+
+		// Free the node of the calling thread for key (without cleanup).
+		void _tss_detach(_tss_key *key) NOEXCEPT_FUNCTION;
+
+		// Run the cleanups of all values of the calling thread; called by
+		// thread::wrapper_function when the thread function returns.
+		void _tss_run_cleanups() NOEXCEPT_FUNCTION;
+	}
+
+	//! Thread specific pointer.
+	//! Holds a separate pointer for each thread, initially null. When a thread
+	//! exits, its non-null pointer is passed to the cleanup function (@c delete
+	//! by default). Example usage:
+	//! @code
+	//! thread_specific_ptr<buffer> scratch;
+	//!
+	//! if (!scratch.get())
+	//!     scratch.reset(new buffer());
+	//! scratch->append(data);
+	//! @endcode
+	//! @note Destroying the object cleans up the value of the calling thread
+	//! only, like @c pthread_key_delete() the values of other threads are not
+	//! cleaned up (they are dropped when those threads exit).
+	template<class T>
+	class thread_specific_ptr
+	{
+	public:
+		typedef void(*cleanup_function)(T*);
+
+		//! Construct with @c delete as cleanup function.
+		//! @throws system_error if the key can't be created.
+		thread_specific_ptr() :
+			_key(detail::_tss_create_key()),
+			_cleanup(&_default_cleanup)
+		{
+		}
+
+		//! Construct with @a cleanup as cleanup function; 0 for no cleanup.
+		//! @throws system_error if the key can't be created.
+		explicit thread_specific_ptr(cleanup_function cleanup) :
+			_key(detail::_tss_create_key()),
+			_cleanup(cleanup)
+		{
+		}
+
+		~thread_specific_ptr()
+		{
+			reset();
+			detail::_tss_detach(_key);
+			detail::_tss_delete_key(_key);
+		}
+
+		//! Pointer of the calling thread.
+		T* get() const NOEXCEPT_FUNCTION
+		{
+			detail::_tss_node *node = _node();
+			return node ? static_cast<T*>(node->value) : 0;
+		}
+
+		T* operator->() const NOEXCEPT_FUNCTION
+		{
+			return get();
+		}
+
+		T& operator*() const NOEXCEPT_FUNCTION
+		{
+			return *get();
+		}
+
+		//! Give up the pointer of the calling thread without cleaning it up.
+		T* release() NOEXCEPT_FUNCTION
+		{
+			detail::_tss_node *node = _node();
+
+			if (!node)
+				return 0;
+
+			T *p = static_cast<T*>(node->value);
+			node->value = 0;
+
+			return p;
+		}
+
+		//! Replace the pointer of the calling thread with @a p; the old one is
+		//! cleaned up if it differs from @a p.
+		void reset(T *p = 0)
+		{
+			detail::_tss_node *node = _node();
+
+			if (!node)
+			{
+				if (!p)
+					return;
+
+				node = detail::_tss_attach(_key, _cleanup ? reinterpret_cast<void(*)()>(_cleanup) : 0, &_invoke);
+			}
+
+			T *old = static_cast<T*>(node->value);
+			node->value = p;
+
+			if (old && old != p && _cleanup)
+				_cleanup(old);
+		}
+
+	private:
+		detail::_tss_key *_key;
+		cleanup_function _cleanup;
+
+		detail::_tss_node* _node() const NOEXCEPT_FUNCTION
+		{
+			return static_cast<detail::_tss_node*>(pthread_getspecific(_key->key));
+		}
+
+		static void _default_cleanup(T *p)
+		{
+			delete p;
+		}
+
+		static void _invoke(void(*cleanup)(), void *p)
+		{
+			reinterpret_cast<cleanup_function>(cleanup)(static_cast<T*>(p));
+		}
+
+		thread_specific_ptr(const thread_specific_ptr&) DELETED_FUNCTION;
+		thread_specific_ptr& operator=(const thread_specific_ptr&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_THREAD_SPECIFIC_PTR_H
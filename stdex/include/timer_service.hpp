@@ -0,0 +1,206 @@
+#ifndef _STDEX_TIMER_SERVICE_H
+#define _STDEX_TIMER_SERVICE_H
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// stdex includes
+#include "./chrono"
+#include "./mutex"
+#include "./condition_variable"
+#include "./thread"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <cstddef>
+#include <vector>
+
+#ifdef _STDEX_HAS_CPP11_SUPPORT
+
+#define DELETED_FUNCTION =delete
+#define NOEXCEPT_FUNCTION throw()
+
+#else
+
+#define DELETED_FUNCTION
+#define NOEXCEPT_FUNCTION
+
+#endif
+
+namespace stdex
+{
+	//! Timer service class.
+	//! Runs callbacks at given points of time from a single service thread,
+	//! instead of a thread blocked in @c condition_variable::wait_for() per
+	//! timeout. Timers are kept in a hierarchical timing wheel: a wheel of
+	//! 256 slots one tick (@c options::resolution) wide, and four wheels of
+	//! 64 slots, each slot as wide as the whole wheel below. Scheduling and
+	//! cancelling a timer are O(1); a timer is moved one wheel down at most
+	//! four times on its way to the first wheel. Example usage:
+	//! @code
+	//! timer_service timers;
+	//!
+	//! timer_service::timer_id t = timers.schedule_after(chrono::seconds(5), &on_timeout, request);
+	//! ...
+	//! if (timers.cancel(t))
+	//!   ... // answered in time, on_timeout will not run
+	//! @endcode
+	//! Callbacks run on the service thread, in deadline order per tick, unless
+	//! a dispatch function is given; it is then called in their place and may
+	//! hand them to another thread (a thread_pool f.e.). A slow callback
+	//! delays all timers due after it; callbacks must not throw.
+	class timer_service
+	{
+		struct timer;
+
+	public:
+		typedef void(*callback_type)(void *);
+
+		//! Called on the service thread with the callback and argument of each
+		//! timer that is due, and with @c options::dispatch_context.
+		typedef void(*dispatch_type)(callback_type func, void *arg, void *context);
+
+		//! Handle of a scheduled timer; a default constructed one refers to no timer.
+		class timer_id
+		{
+		public:
+			timer_id() NOEXCEPT_FUNCTION :
+				_timer(0),
+				_generation(0)
+			{}
+
+			inline friend bool operator==(const timer_id &a, const timer_id &b) NOEXCEPT_FUNCTION
+			{
+				return a._timer == b._timer && a._generation == b._generation;
+			}
+
+			inline friend bool operator!=(const timer_id &a, const timer_id &b) NOEXCEPT_FUNCTION
+			{
+				return !(a == b);
+			}
+
+		private:
+			friend class timer_service;
+
+			timer *_timer;
+			unsigned long _generation; //!< Tells a reused timer from the one scheduled.
+
+			timer_id(timer *t, unsigned long generation) NOEXCEPT_FUNCTION :
+				_timer(t),
+				_generation(generation)
+			{}
+		};
+
+		//! How the service runs.
+		struct options
+		{
+			chrono::microseconds resolution;  //!< Tick of the timing wheel; deadlines are rounded up to it.
+			chrono::microseconds slack;       //!< Coalescing tolerance: a timer may run this much later
+			                                  //!< than its deadline so timers due close together run in
+			                                  //!< one wake-up of the service thread.
+			dispatch_type dispatch;           //!< Runs the due callbacks; 0 to run them on the service thread.
+			void *dispatch_context;           //!< Passed to @c dispatch.
+
+			options() :
+				resolution(chrono::milliseconds(1)),
+				slack(0),
+				dispatch(0),
+				dispatch_context(0)
+			{}
+		};
+
+		//! Constructor.
+		//! Starts the service thread.
+		//! @throws system_error if the thread can't be started.
+		explicit timer_service(const options &opts = options());
+
+		//! Destructor.
+		//! Stops the service thread; timers still pending are dropped without
+		//! running.
+		~timer_service();
+
+		//! Run <tt>func(arg)</tt> once @a rtime has passed.
+		template<class _Rep, class _Period>
+		timer_id schedule_after(const chrono::duration<_Rep, _Period> &rtime, callback_type func, void *arg)
+		{
+			return schedule_at(chrono::steady_clock::now() + chrono::ceil<chrono::microseconds>(rtime), func, arg);
+		}
+
+		//! Run <tt>func(arg)</tt> at @a atime (or as soon as possible if that
+		//! has passed).
+		template<class _Duration>
+		timer_id schedule_at(const chrono::time_point<chrono::steady_clock, _Duration> &atime, callback_type func, void *arg)
+		{
+			return _schedule(chrono::ceil<chrono::microseconds>(atime.time_since_epoch()).count(), func, arg);
+		}
+
+		//! Run <tt>func(arg)</tt> at @a atime of another clock; converted to
+		//! steady_clock once, so later adjustments of @a _Clock are not followed.
+		template<class _Clock, class _Duration>
+		timer_id schedule_at(const chrono::time_point<_Clock, _Duration> &atime, callback_type func, void *arg)
+		{
+			return schedule_after(atime - _Clock::now(), func, arg);
+		}
+
+		//! Cancel a timer.
+		//! @return @c true if the timer was pending and will not run, @c false
+		//! if it has run (or is running) already or was cancelled before.
+		bool cancel(timer_id id);
+
+		//! Number of timers scheduled but not due yet.
+		std::size_t pending() const;
+
+	private:
+		enum
+		{
+			_root_bits = 8,                        // first wheel: 256 slots
+			_level_bits = 6,                       // other wheels: 64 slots
+			_levels = 5,
+			_root_size = 1 << _root_bits,
+			_level_size = 1 << _level_bits,
+			_slots = _root_size + (_levels - 1) * _level_size,
+			_bitmap_words = _slots / 64
+		};
+
+		options _opts;
+		intmax_t _origin_us;                // steady_clock time of tick 0
+		intmax_t _tick_us;
+
+		mutable mutex _lock;
+		condition_variable _wake_up;
+
+		// Everything below is guarded by _lock
+		timer *_wheel[_slots];
+		uintmax_t _occupied[_bitmap_words]; // bit per non-empty slot
+		uintmax_t _now;                     // next tick to process
+		uintmax_t _wake_tick;               // tick the service thread sleeps until
+		std::size_t _pending;
+		timer *_free;                       // unused timers, linked by next
+		std::vector<timer*> _blocks;        // allocated arrays of timers
+		bool _stopping;
+
+		thread _thread;
+
+		timer_id _schedule(intmax_t deadline_us, callback_type func, void *arg);
+		timer* _allocate();
+		void _release(timer *t);
+		void _insert(timer *t);
+		void _unlink(timer *t);
+		void _cascade(unsigned level);
+		timer* _advance(uintmax_t tick);
+		uintmax_t _next_event() const;
+		uintmax_t _tick_at(intmax_t time_us) const;
+		intmax_t _time_of(uintmax_t tick) const;
+		void _run();
+
+		static void _thread_main(void *aArg);
+
+		timer_service(const timer_service&) DELETED_FUNCTION;
+		timer_service& operator=(const timer_service&) DELETED_FUNCTION;
+	};
+} // namespace stdex
+
+#endif // _STDEX_TIMER_SERVICE_H
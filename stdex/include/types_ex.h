@@ -2,7 +2,7 @@
 #define STDEX_TYPES_H
 
 #if __cplusplus >= 201103L || _MSC_VER >= 1900
-
+	#include <stdint.h>
 #else
 	#if defined(_MSC_VER) || defined(__BORLANDC__)
 		typedef __int16 int16_t;
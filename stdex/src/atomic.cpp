@@ -0,0 +1,30 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/atomic"
+
+// POSIX includes
+#include <pthread>
+
+// std includes
+/*none*/
+
+using namespace stdex;
+
+#ifdef _STDEX_ATOMIC_USES_LOCK
+
+namespace
+{
+	pthread_mutex_t atomic_ops_lock = PTHREAD_MUTEX_INITIALIZER;
+}
+
+void detail::_atomic_lock()
+{
+	pthread_mutex_lock(&atomic_ops_lock);
+}
+
+void detail::_atomic_unlock()
+{
+	pthread_mutex_unlock(&atomic_ops_lock);
+}
+
+#endif // _STDEX_ATOMIC_USES_LOCK
@@ -0,0 +1,153 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/bench"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <algorithm>
+#include <iomanip>
+#include <cstdio>
+
+using namespace stdex;
+
+namespace
+{
+	// Nearest-rank percentile of sorted samples.
+	double _percentile(const std::vector<double> &sorted, unsigned p)
+	{
+		std::size_t rank = (sorted.size() * p + 99) / 100;
+
+		return sorted[rank ? rank - 1 : 0];
+	}
+
+	void _write_json_string(std::ostream &out, const std::string &s)
+	{
+		out << '"';
+
+		for (std::size_t i = 0; i < s.size(); ++i)
+		{
+			const unsigned char c = static_cast<unsigned char>(s[i]);
+
+			if (c == '"' || c == '\\')
+				out << '\\' << s[i];
+			else if (c < 0x20)
+			{
+				char buf[8];
+				std::sprintf(buf, "\\u%04x", c);
+				out << buf;
+			}
+			else
+				out << s[i];
+		}
+
+		out << '"';
+	}
+
+	void _write_json_number(std::ostream &out, double value)
+	{
+		char buf[64];
+		std::sprintf(buf, "%.3f", value);
+		out << buf;
+	}
+}
+
+const bench::result& bench::runner::_add(const std::string &name, unsigned threads, unsigned long n, std::vector<double> &samples)
+{
+	result r;
+
+	r.name = name;
+	r.threads = threads;
+	r.runs = static_cast<unsigned>(samples.size());
+	r.iterations = n;
+	r.min = r.mean = r.p50 = r.p90 = r.p99 = r.max = 0;
+
+	if (!samples.empty())
+	{
+		std::sort(samples.begin(), samples.end());
+
+		double sum = 0;
+		for (std::size_t i = 0; i < samples.size(); ++i)
+			sum += samples[i];
+
+		r.min = samples.front();
+		r.mean = sum / samples.size();
+		r.p50 = _percentile(samples, 50);
+		r.p90 = _percentile(samples, 90);
+		r.p99 = _percentile(samples, 99);
+		r.max = samples.back();
+	}
+
+	_results.push_back(r);
+
+	return _results.back();
+}
+
+void bench::runner::write_text(std::ostream &out) const
+{
+	std::size_t name_width = 9;
+
+	for (std::size_t i = 0; i < _results.size(); ++i)
+		name_width = (std::max)(name_width, _results[i].name.size());
+
+	out << std::left << std::setw(static_cast<int>(name_width)) << "benchmark" << std::right
+		<< std::setw(8) << "threads"
+		<< std::setw(12) << "min ns"
+		<< std::setw(12) << "p50 ns"
+		<< std::setw(12) << "p90 ns"
+		<< std::setw(12) << "p99 ns"
+		<< std::setw(12) << "max ns" << '\n';
+
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::fixed << std::setprecision(2);
+
+	for (std::size_t i = 0; i < _results.size(); ++i)
+	{
+		const result &r = _results[i];
+
+		out << std::left << std::setw(static_cast<int>(name_width)) << r.name << std::right
+			<< std::setw(8) << r.threads
+			<< std::setw(12) << r.min
+			<< std::setw(12) << r.p50
+			<< std::setw(12) << r.p90
+			<< std::setw(12) << r.p99
+			<< std::setw(12) << r.max << '\n';
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+void bench::runner::write_json(std::ostream &out) const
+{
+	out << "{\"benchmarks\": [";
+
+	for (std::size_t i = 0; i < _results.size(); ++i)
+	{
+		const result &r = _results[i];
+
+		out << (i ? ",\n  " : "\n  ") << "{\"name\": ";
+		_write_json_string(out, r.name);
+		out << ", \"threads\": " << r.threads
+			<< ", \"runs\": " << r.runs
+			<< ", \"iterations\": " << r.iterations
+			<< ", \"ns_per_iteration\": {\"min\": ";
+		_write_json_number(out, r.min);
+		out << ", \"mean\": ";
+		_write_json_number(out, r.mean);
+		out << ", \"p50\": ";
+		_write_json_number(out, r.p50);
+		out << ", \"p90\": ";
+		_write_json_number(out, r.p90);
+		out << ", \"p99\": ";
+		_write_json_number(out, r.p99);
+		out << ", \"max\": ";
+		_write_json_number(out, r.max);
+		out << "}}";
+	}
+
+	out << (_results.empty() ? "]}\n" : "\n]}\n");
+}
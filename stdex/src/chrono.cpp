@@ -1,5 +1,6 @@
 // stdex includes
 #include "../include/chrono"
+#include "../include/mutex" // for call_once
 
 // POSIX includes
 #include <time.h> // for clock_gettime
@@ -126,21 +127,27 @@ namespace clock_gettime_impl
 
 LARGE_INTEGER performanceFrequency;
 
-const bool system_clock::is_steady = QueryPerformanceFrequency(&performanceFrequency);
+const bool system_clock::is_steady = false;
 const bool steady_clock::is_steady = QueryPerformanceFrequency(&performanceFrequency);
 
 #define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1 // emulated clock_gettime is performance counter based for any clock
 int(*clock_gettime_func_pointer)(int X, mytimespec *tv) = &clock_gettime_impl::clock_gettime;
 #else
 struct mytimespec:
 	public timespec
 {};
 
-const bool system_clock::is_steady = true;
+const bool system_clock::is_steady = false;
+
+#ifdef CLOCK_MONOTONIC
 const bool steady_clock::is_steady = true;
+#else
+#define CLOCK_MONOTONIC CLOCK_REALTIME // no monotonic clock on this platform
+const bool steady_clock::is_steady = false;
+#endif
 
-int clock_gettime(int X, timespec *tv);
-int(*clock_gettime_func_pointer)(int X, timespec *tv) = &clock_gettime;
+int(*clock_gettime_func_pointer)(clockid_t X, timespec *tv) = &::clock_gettime;
 #endif
 
 system_clock::time_point system_clock::now()
@@ -163,7 +170,7 @@ steady_clock::time_point steady_clock::now()
 	{
 		mytimespec ts;
 
-		if ((*clock_gettime_func_pointer)(CLOCK_REALTIME, &ts) != 0)
+		if ((*clock_gettime_func_pointer)(CLOCK_MONOTONIC, &ts) != 0)
 		{
 			std::terminate();
 		}
@@ -171,4 +178,117 @@ steady_clock::time_point steady_clock::now()
 		return time_point(duration(
 			seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec)));
 	}
-}
\ No newline at end of file
+}
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+	#define _STDEX_HAS_TSC
+#endif
+
+#ifdef _STDEX_HAS_TSC
+
+#ifdef _MSC_VER
+#include <intrin.h> // for __rdtsc and __cpuid
+#elif defined(__GNUC__)
+#include <cpuid.h> // for __get_cpuid
+#endif
+
+namespace fast_steady_clock_impl
+{
+	inline stdex::intmax_t rdtsc()
+	{
+#ifdef _MSC_VER
+		return static_cast<stdex::intmax_t>(__rdtsc());
+#else
+		unsigned int lo, hi;
+		__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+		return static_cast<stdex::intmax_t>((static_cast<stdex::uintmax_t>(hi) << 32) | lo);
+#endif
+	}
+
+	// The TSC is usable as a clock only if it ticks at a constant rate
+	// regardless of frequency scaling and sleep states (CPUID 80000007h, EDX bit 8).
+	bool tsc_is_invariant()
+	{
+		unsigned int regs[4] = { 0, 0, 0, 0 };
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0x80000000);
+		if (static_cast<unsigned int>(info[0]) < 0x80000007)
+			return false;
+		__cpuid(info, 0x80000007);
+		regs[3] = static_cast<unsigned int>(info[3]);
+#elif defined(__GNUC__)
+		if (__get_cpuid_max(0x80000000, 0) < 0x80000007)
+			return false;
+		__get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+		return (regs[3] & (1u << 8)) != 0;
+	}
+
+	inline stdex::intmax_t monotonic_ns()
+	{
+		mytimespec ts;
+
+		if ((*clock_gettime_func_pointer)(CLOCK_MONOTONIC, &ts) != 0)
+		{
+			std::terminate();
+		}
+
+		return static_cast<stdex::intmax_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+	const bool use_tsc = tsc_is_invariant();
+
+	stdex::intmax_t base_tsc = 0;
+	stdex::intmax_t base_ns = 0;
+	double ns_per_tick = 0.0;
+
+	atomic<int> calibrated; // zero-initialized, see detail::_call_once
+
+	void calibrate()
+	{
+		const stdex::intmax_t calibration_period_ns = 10000000; // 10 ms
+
+		stdex::intmax_t tsc0 = rdtsc();
+		stdex::intmax_t ns0 = monotonic_ns();
+		stdex::intmax_t ns1;
+
+		do
+		{
+			ns1 = monotonic_ns();
+		} while (ns1 - ns0 < calibration_period_ns);
+
+		stdex::intmax_t tsc1 = rdtsc();
+
+		ns_per_tick = static_cast<double>(ns1 - ns0) / static_cast<double>(tsc1 - tsc0);
+		base_tsc = tsc1;
+		base_ns = ns1;
+	}
+}
+
+const bool fast_steady_clock::is_steady = fast_steady_clock_impl::use_tsc || steady_clock::is_steady;
+
+fast_steady_clock::time_point fast_steady_clock::now()
+{
+	using namespace fast_steady_clock_impl;
+
+	if (!use_tsc)
+		return time_point(steady_clock::now().time_since_epoch());
+
+	detail::_call_once(calibrated, &calibrate);
+
+	stdex::intmax_t ticks = rdtsc() - base_tsc;
+
+	return time_point(duration(base_ns + static_cast<stdex::intmax_t>(static_cast<double>(ticks) * ns_per_tick)));
+}
+
+#else
+
+const bool fast_steady_clock::is_steady = steady_clock::is_steady;
+
+fast_steady_clock::time_point fast_steady_clock::now()
+{
+	return time_point(steady_clock::now().time_since_epoch());
+}
+
+#endif // _STDEX_HAS_TSC
@@ -1,14 +1,168 @@
 // stdex includes
+#include "../include/core.h"
 #include "../include/mutex"
 
 // POSIX includes
-/*none*/
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 // std includes
-/*none*/
+#include <cstddef>
+#include <climits> // for INT_MAX
 
 using namespace stdex;
 
 const adopt_lock_t adopt_lock;
 const defer_lock_t defer_lock;
 const try_to_lock_t try_to_lock;
+
+// the futex word is the value of the atomic itself
+STATIC_ASSERT(sizeof(atomic<int>) == sizeof(int), atomic_int_must_be_a_plain_int);
+
+#ifdef __linux__
+
+void detail::futex_wait(atomic<int> &word, int expected)
+{
+	syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+void detail::futex_wake(atomic<int> &word, int count)
+{
+	syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+bool detail::futex_wait_until(atomic<int> &word, int expected, const chrono::steady_clock::time_point &deadline)
+{
+	// FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC time, unlike FUTEX_WAIT
+	timespec ts = _to_timespec(deadline);
+
+	if (syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_BITSET_PRIVATE, expected, &ts, NULL, FUTEX_BITSET_MATCH_ANY) == -1)
+		return (errno != ETIMEDOUT);
+
+	return true;
+}
+
+#else // emulate futex with a table of condition variables hashed by address
+
+namespace
+{
+	struct futex_bucket
+	{
+		pthread_mutex_t lock;
+		pthread_cond_t cond;
+	};
+
+	futex_bucket futex_buckets[64];
+	pthread_once_t futex_buckets_once = PTHREAD_ONCE_INIT; // call_once itself waits on the futex
+
+	void init_futex_buckets()
+	{
+		for (std::size_t i = 0; i < countof(futex_buckets); ++i)
+		{
+			pthread_mutex_init(&futex_buckets[i].lock, NULL);
+			pthread_cond_init(&futex_buckets[i].cond, NULL);
+		}
+	}
+
+	futex_bucket& get_futex_bucket(atomic<int> &word)
+	{
+		pthread_once(&futex_buckets_once, &init_futex_buckets);
+
+		std::size_t h = reinterpret_cast<std::size_t>(&word);
+		return futex_buckets[(h >> 4) % countof(futex_buckets)];
+	}
+}
+
+void detail::futex_wait(atomic<int> &word, int expected)
+{
+	futex_bucket &b = get_futex_bucket(word);
+
+	// wakers change the word before they take the bucket lock, so the value
+	// can't change unnoticed between this check and the wait
+	pthread_mutex_lock(&b.lock);
+	if (word.load() == expected)
+		pthread_cond_wait(&b.cond, &b.lock);
+	pthread_mutex_unlock(&b.lock);
+}
+
+bool detail::futex_wait_until(atomic<int> &word, int expected, const chrono::steady_clock::time_point &deadline)
+{
+	futex_bucket &b = get_futex_bucket(word);
+
+	// the bucket condition variables wait on the system clock
+	timespec ts = _to_timespec(chrono::system_clock::now() + (deadline - chrono::steady_clock::now()));
+	int res = 0;
+
+	pthread_mutex_lock(&b.lock);
+	if (word.load() == expected)
+		res = pthread_cond_timedwait(&b.cond, &b.lock, &ts);
+	pthread_mutex_unlock(&b.lock);
+
+	return (res != ETIMEDOUT);
+}
+
+void detail::futex_wake(atomic<int> &word, int)
+{
+	futex_bucket &b = get_futex_bucket(word);
+
+	// the bucket is shared by other addresses so wake everybody, the rest
+	// will see a spurious wake up
+	pthread_mutex_lock(&b.lock);
+	pthread_cond_broadcast(&b.cond);
+	pthread_mutex_unlock(&b.lock);
+}
+
+#endif // __linux__
+
+void adaptive_mutex::_lock_contended()
+{
+	// spin while the owner is likely to release the lock soon
+	for (unsigned i = 0, backoff = 1; i < _spin_count; ++i)
+	{
+		for (unsigned j = 0; j < backoff; ++j)
+			detail::cpu_relax();
+
+		if (backoff < 64)
+			backoff <<= 1;
+
+		int expected = _unlocked;
+
+		if (_state.load(memory_order_relaxed) == _unlocked &&
+			_state.compare_exchange_strong(expected, _locked, memory_order_acquire))
+			return;
+	}
+
+	// park: mark the mutex contended so that unlock() wakes us up
+	while (_state.exchange(_contended, memory_order_acquire) != _unlocked)
+		detail::futex_wait(_state, _contended);
+}
+
+bool detail::_once_begin(atomic<int> &state)
+{
+	for (;;)
+	{
+		int s = _once_not_called;
+
+		if (state.compare_exchange_strong(s, _once_running, memory_order_acquire))
+			return true;
+
+		if (s == _once_done)
+			return false;
+
+		// tell the running thread to wake us up
+		if (s == _once_running &&
+			!state.compare_exchange_strong(s, _once_running_waiters, memory_order_acquire))
+			continue;
+
+		futex_wait(state, _once_running_waiters);
+	}
+}
+
+void detail::_once_end(atomic<int> &state, bool called)
+{
+	if (state.exchange(called ? _once_done : _once_not_called, memory_order_release) == _once_running_waiters)
+		futex_wake(state, INT_MAX);
+}
@@ -0,0 +1,190 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/profiled_mutex"
+
+// POSIX includes
+#include <time.h>
+
+// std includes
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+using namespace stdex;
+
+namespace
+{
+	// Registered lock sites, most recent first; only ever grows.
+	atomic<detail::_mutex_profile_site*> _sites; // zero-initialized
+
+	bool _more_waiting(const mutex_stats &a, const mutex_stats &b)
+	{
+		if (a.wait_time != b.wait_time)
+			return a.wait_time > b.wait_time;
+
+		return a.contended > b.contended;
+	}
+
+	bool _site_more_waiting(const mutex_site_stats &a, const mutex_site_stats &b)
+	{
+		return _more_waiting(a.total, b.total);
+	}
+
+	mutex_stats _read(const detail::_mutex_profile_record &r)
+	{
+		mutex_stats stats;
+
+		stats.owner = r.owner;
+		stats.acquisitions = r.acquisitions.load(memory_order_relaxed);
+		stats.contended = r.contended.load(memory_order_relaxed);
+		stats.wait_time = chrono::nanoseconds(r.wait_ns.load(memory_order_relaxed));
+		stats.max_wait_time = chrono::nanoseconds(r.max_wait_ns.load(memory_order_relaxed));
+		stats.hold_time = chrono::nanoseconds(r.hold_ns.load(memory_order_relaxed));
+		stats.max_hold_time = chrono::nanoseconds(r.max_hold_ns.load(memory_order_relaxed));
+
+		return stats;
+	}
+
+	void _accumulate(mutex_stats &total, const mutex_stats &stats)
+	{
+		total.acquisitions += stats.acquisitions;
+		total.contended += stats.contended;
+		total.wait_time += stats.wait_time;
+		total.hold_time += stats.hold_time;
+		total.max_wait_time = (std::max)(total.max_wait_time, stats.max_wait_time);
+		total.max_hold_time = (std::max)(total.max_hold_time, stats.max_hold_time);
+	}
+
+	double _ms(const chrono::nanoseconds &d)
+	{
+		return static_cast<double>(d.count()) / 1000000.0;
+	}
+
+	double _us(const chrono::nanoseconds &d)
+	{
+		return static_cast<double>(d.count()) / 1000.0;
+	}
+
+	void _write_row(std::ostream &out, const mutex_stats &stats)
+	{
+		out << std::setw(12) << stats.acquisitions
+			<< std::setw(12) << stats.contended
+			<< std::setw(12) << _ms(stats.wait_time)
+			<< std::setw(12) << _us(stats.max_wait_time)
+			<< std::setw(12) << _ms(stats.hold_time)
+			<< std::setw(12) << _us(stats.max_hold_time) << '\n';
+	}
+}
+
+void detail::_mutex_profile_register(_mutex_profile_site &site, const char *name)
+{
+	site.name = name;
+
+	_mutex_profile_site *head = _sites.load(memory_order_relaxed);
+
+	do
+	{
+		site.next = head;
+	} while (!_sites.compare_exchange_weak(head, &site, memory_order_release, memory_order_relaxed));
+}
+
+detail::_mutex_profile_record* detail::_mutex_profile_attach(_mutex_profile_site &site)
+{
+	_mutex_profile_record *r = new _mutex_profile_record;
+
+	r->owner = this_thread::get_id();
+	r->acquisitions.store(0, memory_order_relaxed);
+	r->contended.store(0, memory_order_relaxed);
+	r->wait_ns.store(0, memory_order_relaxed);
+	r->max_wait_ns.store(0, memory_order_relaxed);
+	r->hold_ns.store(0, memory_order_relaxed);
+	r->max_hold_ns.store(0, memory_order_relaxed);
+
+	_mutex_profile_record *head = site.records.load(memory_order_relaxed);
+
+	do
+	{
+		r->next = head;
+	} while (!site.records.compare_exchange_weak(head, r, memory_order_release, memory_order_relaxed));
+
+	return r;
+}
+
+intmax_t detail::_mutex_profile_now() NOEXCEPT_FUNCTION
+{
+	timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return static_cast<intmax_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+std::vector<mutex_site_stats> stdex::mutex_profile_snapshot()
+{
+	std::vector<mutex_site_stats> sites;
+
+	for (detail::_mutex_profile_site *site = _sites.load(memory_order_acquire); site; site = site->next)
+	{
+		mutex_site_stats stats;
+
+		stats.site = site->name;
+
+		for (detail::_mutex_profile_record *r = site->records.load(memory_order_acquire); r; r = r->next)
+		{
+			stats.threads.push_back(_read(*r));
+			_accumulate(stats.total, stats.threads.back());
+		}
+
+		std::sort(stats.threads.begin(), stats.threads.end(), &_more_waiting);
+		sites.push_back(stats);
+	}
+
+	std::sort(sites.begin(), sites.end(), &_site_more_waiting);
+
+	return sites;
+}
+
+void stdex::write_mutex_profile(std::ostream &out)
+{
+	std::vector<mutex_site_stats> sites = mutex_profile_snapshot();
+	std::size_t name_width = 4;
+
+	for (std::size_t i = 0; i < sites.size(); ++i)
+		name_width = (std::max)(name_width, std::strlen(sites[i].site));
+
+	name_width += 4; // room for the thread lines
+
+	out << std::left << std::setw(static_cast<int>(name_width)) << "site" << std::right
+		<< std::setw(12) << "locks"
+		<< std::setw(12) << "contended"
+		<< std::setw(12) << "wait ms"
+		<< std::setw(12) << "max wait us"
+		<< std::setw(12) << "hold ms"
+		<< std::setw(12) << "max hold us" << '\n';
+
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::fixed << std::setprecision(3);
+
+	for (std::size_t i = 0; i < sites.size(); ++i)
+	{
+		const mutex_site_stats &site = sites[i];
+
+		out << std::left << std::setw(static_cast<int>(name_width)) << site.site << std::right;
+		_write_row(out, site.total);
+
+		for (std::size_t j = 0; j < site.threads.size(); ++j)
+		{
+			std::ostringstream owner;
+
+			owner << "  " << site.threads[j].owner;
+			out << std::left << std::setw(static_cast<int>(name_width)) << owner.str() << std::right;
+			_write_row(out, site.threads[j]);
+		}
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
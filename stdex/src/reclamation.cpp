@@ -0,0 +1,411 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/reclamation"
+#include "../include/system_error"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <algorithm>
+
+using namespace stdex;
+
+namespace
+{
+	// Call the deleters of objects; the list is taken over first because a
+	// deleter may retire more objects.
+	void _reclaim_all(std::vector<detail::_retired> &objects)
+	{
+		std::vector<detail::_retired> taken;
+
+		taken.swap(objects);
+
+		for (std::size_t i = 0; i < taken.size(); ++i)
+			taken[i].reclaim();
+	}
+}
+
+struct epoch_domain::record
+{
+	atomic<unsigned long> local;       // (epoch << 1) | 1 inside a guard, 0 outside
+	atomic<bool> in_use;               // owned by a live thread
+	unsigned depth;                    // nesting of guards, owner only
+	std::vector<detail::_retired> limbo[3]; // retired in epoch limbo_epoch[i], i = epoch % 3
+	unsigned long limbo_epoch[3];
+	std::size_t retired;               // objects in limbo
+	epoch_domain *domain;
+	record *next;
+
+	explicit record(epoch_domain *domain_) :
+		local(0),
+		in_use(true),
+		depth(0),
+		retired(0),
+		domain(domain_),
+		next(0)
+	{
+		limbo_epoch[0] = limbo_epoch[1] = limbo_epoch[2] = 0;
+	}
+};
+
+epoch_domain::epoch_domain(std::size_t threshold) :
+	_epoch(0),
+	_records(0),
+	_threshold(threshold ? threshold : 1),
+	_local(&_release)
+{}
+
+epoch_domain::~epoch_domain()
+{
+	// The record of the calling thread goes with the others below
+	_local.release();
+
+	record *r = _records.load(memory_order_acquire);
+
+	while (r)
+	{
+		record *next = r->next;
+
+		for (int i = 0; i < 3; ++i)
+			_reclaim_all(r->limbo[i]);
+
+		delete r;
+		r = next;
+	}
+}
+
+epoch_domain::record* epoch_domain::_enter()
+{
+	record *r = _local.get();
+
+	if (!r)
+		r = &_acquire();
+
+	if (r->depth++ == 0)
+	{
+		unsigned long local = (_epoch.load(memory_order_relaxed) << 1) | 1;
+
+		// The epoch must be published before the structure is read; a
+		// locked exchange is a full barrier on x86 and cheaper than mfence
+#if (defined(__GNUC__) || defined(_MSC_VER)) && (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+		r->local.exchange(local, memory_order_seq_cst);
+#else
+		r->local.store(local, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+#endif
+	}
+
+	return r;
+}
+
+void epoch_domain::_leave(record &r) NOEXCEPT_FUNCTION
+{
+	if (--r.depth == 0)
+		r.local.store(0, memory_order_release);
+}
+
+epoch_domain::record& epoch_domain::_acquire()
+{
+	record *r = _local.get();
+
+	if (r)
+		return *r;
+
+	// Adopt the record of a thread that has exited, with what it left to reclaim
+	for (r = _records.load(memory_order_acquire); r; r = r->next)
+	{
+		bool expected = false;
+
+		if (!r->in_use.load(memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+			break;
+	}
+
+	if (!r)
+	{
+		r = new record(this);
+
+		record *head = _records.load(memory_order_relaxed);
+
+		do
+		{
+			r->next = head;
+		} while (!_records.compare_exchange_weak(head, r, memory_order_release, memory_order_relaxed));
+	}
+
+	_local.reset(r);
+
+	return *r;
+}
+
+void epoch_domain::_retire(const detail::_retired &object)
+{
+	record &r = _acquire();
+
+	// The object was unlinked before; an epoch read after that is one no
+	// reader that can still hold the object has left yet
+	atomic_thread_fence(memory_order_seq_cst);
+
+	unsigned long epoch = _epoch.load(memory_order_relaxed);
+	unsigned i = epoch % 3;
+
+	// The list of the same index is three epochs old or more
+	if (r.limbo_epoch[i] != epoch)
+	{
+		r.retired -= r.limbo[i].size();
+		_reclaim_all(r.limbo[i]);
+		r.limbo_epoch[i] = epoch;
+	}
+
+	r.limbo[i].push_back(object);
+
+	if (++r.retired >= _threshold)
+		collect();
+}
+
+void epoch_domain::collect()
+{
+	record &r = _acquire();
+	unsigned long epoch = _epoch.load(memory_order_relaxed);
+
+	if (_try_advance(epoch))
+		++epoch;
+
+	_reclaim(r, epoch);
+
+	// Also what exited threads have left behind
+	for (record *it = _records.load(memory_order_acquire); it; it = it->next)
+	{
+		bool expected = false;
+
+		if (!it->in_use.load(memory_order_relaxed) && it->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+		{
+			_reclaim(*it, epoch);
+			it->in_use.store(false, memory_order_release);
+		}
+	}
+}
+
+bool epoch_domain::_try_advance(unsigned long epoch)
+{
+	atomic_thread_fence(memory_order_seq_cst);
+
+	for (record *r = _records.load(memory_order_acquire); r; r = r->next)
+	{
+		unsigned long local = r->local.load(memory_order_relaxed);
+
+		if ((local & 1) && (local >> 1) != epoch)
+			return false;
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+
+	return _epoch.compare_exchange_strong(epoch, epoch + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+// Delete the objects of r retired two or more epochs before epoch.
+void epoch_domain::_reclaim(record &r, unsigned long epoch)
+{
+	for (unsigned i = 0; i < 3; ++i)
+	{
+		if (!r.limbo[i].empty() && epoch - r.limbo_epoch[i] >= 2)
+		{
+			r.retired -= r.limbo[i].size();
+			_reclaim_all(r.limbo[i]);
+		}
+	}
+}
+
+// Key cleanup, runs when a thread with a record exits.
+void epoch_domain::_release(record *r)
+{
+	epoch_domain &domain = *r->domain;
+	unsigned long epoch = domain._epoch.load(memory_order_relaxed);
+
+	if (domain._try_advance(epoch))
+		++epoch;
+
+	domain._reclaim(*r, epoch);
+
+	r->local.store(0, memory_order_relaxed);
+	r->in_use.store(false, memory_order_release);
+}
+
+struct hazard_domain::record
+{
+	atomic<void*> hazards[max_hazards];
+	unsigned used;                       // bit per hazard pointer taken, owner only
+	atomic<bool> in_use;                 // owned by a live thread
+	std::vector<detail::_retired> retired;
+	std::size_t scan_at;                 // size of retired that triggers a scan
+	hazard_domain *domain;
+	record *next;
+
+	explicit record(hazard_domain *domain_) :
+		used(0),
+		in_use(true),
+		scan_at(domain_->_threshold),
+		domain(domain_),
+		next(0)
+	{
+		for (unsigned i = 0; i < max_hazards; ++i)
+			hazards[i].store(0, memory_order_relaxed);
+	}
+};
+
+hazard_domain::hazard_pointer::hazard_pointer(hazard_domain &domain) :
+	_record(&domain._acquire()),
+	_slot(0)
+{
+	for (unsigned i = 0; i < max_hazards; ++i)
+	{
+		if (!(_record->used & (1u << i)))
+		{
+			_record->used |= 1u << i;
+			_slot = &_record->hazards[i];
+			return;
+		}
+	}
+
+	throw system_error(resource_unavailable_try_again);
+}
+
+hazard_domain::hazard_pointer::~hazard_pointer()
+{
+	_slot->store(0, memory_order_release);
+	_record->used &= ~(1u << static_cast<unsigned>(_slot - _record->hazards));
+}
+
+hazard_domain::hazard_domain(std::size_t threshold) :
+	_records(0),
+	_threshold(threshold ? threshold : 1),
+	_local(&_release)
+{}
+
+hazard_domain::~hazard_domain()
+{
+	// The record of the calling thread goes with the others below
+	_local.release();
+
+	record *r = _records.load(memory_order_acquire);
+
+	while (r)
+	{
+		record *next = r->next;
+
+		_reclaim_all(r->retired);
+
+		delete r;
+		r = next;
+	}
+}
+
+hazard_domain::record& hazard_domain::_acquire()
+{
+	record *r = _local.get();
+
+	if (r)
+		return *r;
+
+	// Adopt the record of a thread that has exited, with what it left to reclaim
+	for (r = _records.load(memory_order_acquire); r; r = r->next)
+	{
+		bool expected = false;
+
+		if (!r->in_use.load(memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+			break;
+	}
+
+	if (!r)
+	{
+		r = new record(this);
+
+		record *head = _records.load(memory_order_relaxed);
+
+		do
+		{
+			r->next = head;
+		} while (!_records.compare_exchange_weak(head, r, memory_order_release, memory_order_relaxed));
+	}
+
+	_local.reset(r);
+
+	return *r;
+}
+
+void hazard_domain::_retire(const detail::_retired &object)
+{
+	record &r = _acquire();
+
+	r.retired.push_back(object);
+
+	if (r.retired.size() >= r.scan_at)
+		_scan(r);
+}
+
+void hazard_domain::collect()
+{
+	_scan(_acquire());
+
+	// Also what exited threads have left behind
+	for (record *it = _records.load(memory_order_acquire); it; it = it->next)
+	{
+		bool expected = false;
+
+		if (!it->in_use.load(memory_order_relaxed) && it->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+		{
+			_scan(*it);
+			it->in_use.store(false, memory_order_release);
+		}
+	}
+}
+
+// Delete the objects retired by r that no hazard pointer holds.
+void hazard_domain::_scan(record &r)
+{
+	// Pairs with the fence between the hazard store and the reload in
+	// protect(): the objects were unlinked before, so a reader either
+	// reloads the new pointer or has its hazard pointer seen here
+	atomic_thread_fence(memory_order_seq_cst);
+
+	std::vector<void*> protected_objects;
+
+	for (record *it = _records.load(memory_order_acquire); it; it = it->next)
+	{
+		for (unsigned i = 0; i < max_hazards; ++i)
+		{
+			void *p = it->hazards[i].load(memory_order_acquire);
+
+			if (p)
+				protected_objects.push_back(p);
+		}
+	}
+
+	std::sort(protected_objects.begin(), protected_objects.end());
+
+	std::vector<detail::_retired> candidates;
+
+	candidates.swap(r.retired);
+
+	std::vector<detail::_retired> reclaimable;
+
+	for (std::size_t i = 0; i < candidates.size(); ++i)
+	{
+		if (std::binary_search(protected_objects.begin(), protected_objects.end(), candidates[i].ptr))
+			r.retired.push_back(candidates[i]);
+		else
+			reclaimable.push_back(candidates[i]);
+	}
+
+	r.scan_at = r.retired.size() + _threshold;
+
+	_reclaim_all(reclaimable);
+}
+
+// Key cleanup, runs when a thread with a record exits.
+void hazard_domain::_release(record *r)
+{
+	r->domain->_scan(*r);
+	r->used = 0;
+	r->in_use.store(false, memory_order_release);
+}
@@ -0,0 +1,49 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/system_error"
+#include "../include/mutex"
+
+// POSIX includes
+/*none*/
+
+// std includes
+/*none*/
+
+using namespace stdex;
+
+namespace
+{
+	// The category objects are created on first use and never destroyed:
+	// error codes are compared by the address of their category and may be
+	// created by constructors and destructors of other static objects.
+	const error_category *_generic_object = 0;
+	const error_category *_iostream_object = 0;
+	const error_category *_system_object = 0;
+
+	atomic<int> _error_objects_once; // zero-initialized, see detail::_call_once
+
+	void _create_error_objects()
+	{
+		_generic_object = new _Generic_error_category();
+		_iostream_object = new _Iostream_error_category();
+		_system_object = new _System_error_category();
+	}
+}
+
+const error_category& stdex::generic_category()
+{	// get generic_category
+	detail::_call_once(_error_objects_once, &_create_error_objects);
+	return (*_generic_object);
+}
+
+const error_category& stdex::iostream_category()
+{	// get iostream_category
+	detail::_call_once(_error_objects_once, &_create_error_objects);
+	return (*_iostream_object);
+}
+
+const error_category& stdex::system_category()
+{	// get system_category
+	detail::_call_once(_error_objects_once, &_create_error_objects);
+	return (*_system_object);
+}
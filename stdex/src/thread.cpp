@@ -1,45 +1,147 @@
 // stdex includes
+#include "../include/core.h"
 #include "../include/thread"
+#include "../include/atomic"
+#include "../include/thread_specific_ptr"
 
 // POSIX includes
-/*none*/
+#include <sched.h>
+#if defined(__FreeBSD__) || defined(__OpenBSD__)
+#include <pthread_np.h> // for pthread_set_name_np
+#endif
 
 // std includes
-#include <map>
+#include <cstddef>
+#include <cerrno>
+#include <ctime> // for clock_nanosleep
+#include <cstring> // for std::memcpy
+#include <new> // for placement new
+
+// CPU affinity is a GNU extension
+#if defined(__GLIBC__) && defined(CPU_SETSIZE)
+#define _STDEX_THREAD_AFFINITY
+#endif
 
 using namespace stdex;
 
-
-bool operator<(const pthread_t &lhs, const pthread_t &rhs)
+namespace
 {
-	if (lhs.p < rhs.p)
-		return true;
-	if (lhs.x < rhs.x)
-		return true;
+	// Last thread id handed out. Ids are never reused; 0 is reserved for
+	// "not a thread". Zero-initialized before any dynamic initialization, so
+	// threads may be started from constructors of other static objects.
+	atomic<unsigned long int> _thread_id_counter;
 
-	return false;
-}
+	unsigned long int _new_thread_id()
+	{
+		return _thread_id_counter.fetch_add(1, memory_order_relaxed) + 1;
+	}
 
+	// Per-thread cached id of the calling thread (0 until first assigned).
+	struct _this_thread_id_tag;
+	typedef thread_local_pod<unsigned long int, _this_thread_id_tag> _this_thread_id;
 
-static thread::id _pthread_t_to_ID(const pthread_t &aHandle)
-{
-	static mutex idMapLock;
-	static std::map<pthread_t, unsigned long int> idMap;
-	static unsigned long int idCount(1);
+#ifdef _STDEX_THREAD_AFFINITY
+	void _to_cpu_set(const thread::cpu_mask &cpus, cpu_set_t &result)
+	{
+		CPU_ZERO(&result);
 
-	lock_guard<mutex> guard(idMapLock);
+		for (unsigned cpu = 0; cpu < thread::cpu_mask::max_cpus && cpu < CPU_SETSIZE; ++cpu)
+			if (cpus.test(cpu))
+				CPU_SET(cpu, &result);
+	}
+#endif
+
+	void _set_this_thread_name(const char *name)
+	{
+#if defined(__GLIBC__) && defined(__USE_GNU)
+		pthread_setname_np(pthread_self(), name);
+#elif defined(__APPLE__)
+		pthread_setname_np(name);
+#elif defined(__FreeBSD__) || defined(__OpenBSD__)
+		pthread_set_name_np(pthread_self(), name);
+#else
+		(void) name; // not supported
+#endif
+	}
 
-	if (idMap.find(aHandle) == idMap.end())
-		idMap[aHandle] = idCount++;
+	// Owns a pthread_attr_t filled from thread::attributes.
+	struct _pthread_attr_guard
+	{
+		pthread_attr_t attr;
 
-	return thread::id(idMap[aHandle]);
+		_pthread_attr_guard()
+		{
+			int e = pthread_attr_init(&attr);
+			if (e)
+				throw system_error(errc(e));
+		}
+
+		~_pthread_attr_guard()
+		{
+			pthread_attr_destroy(&attr);
+		}
+
+		static void check(int e)
+		{
+			if (e)
+				throw system_error(errc(e));
+		}
+
+	private:
+		_pthread_attr_guard(const _pthread_attr_guard&);
+		_pthread_attr_guard& operator=(const _pthread_attr_guard&);
+	};
 }
 
 /// Information to pass to the new thread (what to run).
+/// One block holds the record and, for the member function constructors, a
+/// copy of the callable. It is shared by the thread object and the thread and
+/// freed by whichever lets go of it last; a joined thread's record is thus
+/// freed by the joiner, usually the thread that allocated it.
 struct thread::thread_start_info {
 	void(*exec_function)(void *); ///< Pointer to the function to be executed.
 	void *argument;               ///< Function argument for the thread function.
-	thread *thread_object;          ///< Pointer to the thread object.
+	unsigned long int id;         ///< Id assigned to the thread by its creator.
+	char name[16];                ///< Name to give the thread (empty to keep the default).
+	atomic<bool> finished;        ///< Set by the thread when the function returned.
+	atomic<int> refs;             ///< Owners: the thread object and the thread.
+
+	//! Allocate a record with room for a callable of aArgSize bytes.
+	static thread_start_info* create(std::size_t aArgSize)
+	{
+		void *block = ::operator new(_callable_offset() + aArgSize);
+		thread_start_info *ti = new(block) thread_start_info;
+
+		ti->argument = aArgSize ? callable(ti) : 0;
+		ti->name[0] = 0;
+		ti->finished.store(false, memory_order_relaxed);
+		ti->refs.store(2, memory_order_relaxed);
+
+		return ti;
+	}
+
+	static void* callable(thread_start_info *ti)
+	{
+		return reinterpret_cast<char*>(ti) + _callable_offset();
+	}
+
+	//! Drop one owner; the last one frees the block.
+	void release()
+	{
+		if (refs.fetch_sub(1, memory_order_acq_rel) == 1)
+		{
+			this->~thread_start_info();
+			::operator delete(this);
+		}
+	}
+
+private:
+	union _max_align { void *p; long l; double d; long double ld; void(thread::*mf)(); };
+
+	static std::size_t _callable_offset()
+	{
+		return (sizeof(thread_start_info) + sizeof(_max_align) - 1) / sizeof(_max_align) * sizeof(_max_align);
+	}
 };
 
 // Thread wrapper function.
@@ -48,6 +150,13 @@ void* thread::wrapper_function(void *aArg)
 	// Get thread startup information
 	thread_start_info *ti = (thread_start_info *) aArg;
 
+	// Publish the id the creator assigned so this_thread::get_id() never
+	// has to allocate one
+	_this_thread_id::set(ti->id);
+
+	if (ti->name[0])
+		_set_this_thread_name(ti->name);
+
 	try
 	{
 		// Call the actual client thread function
@@ -60,79 +169,129 @@ void* thread::wrapper_function(void *aArg)
 		std::terminate();
 	}
 
-	// The thread is no longer executing
-	lock_guard<mutex> guard(ti->thread_object->_data_mutex);
-	ti->thread_object->_not_a_thread = true;
+	// Clean up the thread_specific_ptr values while this is still a running
+	// stdex::thread (other threads' pthread_key destructors run later)
+	detail::_tss_run_cleanups();
 
-	// The thread is responsible for freeing the startup information
-	delete ti;
+	// The thread is no longer executing; the thread object may be gone
+	// already (detached), so only the shared record is touched
+	ti->finished.store(true, memory_order_release);
+	ti->release();
 
 	return 0;
 }
 
-void thread::init(void(*aFunction)(void *), void *aArg)
+void thread::init(void(*aFunction)(void *), void *aArg, const attributes *attr, std::size_t aArgSize)
 {
-	// Serialize access to this thread structure
-	lock_guard<mutex> guard(_data_mutex);
+	// Translate the creation attributes first so a bad one leaves this
+	// object untouched
+	_pthread_attr_guard pattr;
 
-	// Fill out the thread startup information (passed to the thread wrapper,
-	// which will eventually free it)
-	_thread_info = new thread_start_info;
-	_thread_info->exec_function = aFunction;
-	_thread_info->argument = aArg;
-	_thread_info->thread_object = this;
+	if (attr)
+	{
+		if (attr->_stack_size)
+			_pthread_attr_guard::check(pthread_attr_setstacksize(&pattr.attr, attr->_stack_size));
 
-	// The thread is now alive
-	_not_a_thread = false;	
+		if (attr->_has_guard_size)
+			_pthread_attr_guard::check(pthread_attr_setguardsize(&pattr.attr, attr->_guard_size));
+
+		if (attr->_has_affinity)
+		{
+#ifdef _STDEX_THREAD_AFFINITY
+			cpu_set_t cpus;
+			_to_cpu_set(attr->_affinity, cpus);
+			_pthread_attr_guard::check(pthread_attr_setaffinity_np(&pattr.attr, sizeof(cpus), &cpus));
+#else
+			throw system_error(not_supported);
+#endif
+		}
+
+		if (attr->_has_scheduling)
+		{
+			sched_param param;
+			param.sched_priority = attr->_priority;
+
+			_pthread_attr_guard::check(pthread_attr_setinheritsched(&pattr.attr, PTHREAD_EXPLICIT_SCHED));
+			_pthread_attr_guard::check(pthread_attr_setschedpolicy(&pattr.attr, attr->_policy));
+			_pthread_attr_guard::check(pthread_attr_setschedparam(&pattr.attr, &param));
+		}
+	}
+
+	// Fill out the thread startup information (shared with the thread
+	// wrapper, see thread_start_info)
+	thread_start_info *ti = thread_start_info::create(aArgSize);
+	ti->exec_function = aFunction;
+	if (aArgSize)
+		std::memcpy(ti->argument, aArg, aArgSize);
+	else
+		ti->argument = aArg;
+	ti->id = _id = _new_thread_id();
+	if (attr)
+		std::memcpy(ti->name, attr->_name, sizeof(ti->name));
 
 	// Create the thread
-	if (pthread_create(&_thread_handle, NULL, &wrapper_function, (void *) _thread_info) != 0)
+	int e = pthread_create(&_thread_handle, &pattr.attr, &wrapper_function, (void *) ti);
+	if (e != 0)
 	{// Did we fail to create the thread?
-		_not_a_thread = true;
-		delete _thread_info;
+		ti->~thread_start_info();
+		::operator delete(ti);
+		throw system_error(error_code(e, system_category()));
 	}
+
+	// The thread is now alive
+	_thread_info.store(ti, memory_order_release);
 }
 
 thread::thread(void(*aFunction)(void *), void * aArg) :
-	_not_a_thread(true)
+	_thread_info(0)
 {
 	init(aFunction, aArg);
 }
 
+thread::thread(const attributes &attr, void(*aFunction)(void *), void * aArg) :
+	_thread_info(0)
+{
+	init(aFunction, aArg, &attr);
+}
+
 thread::~thread()
 {
 	if (joinable())
 		std::terminate();
+
+	// Finished but never joined: let the system reclaim the thread
+	detach();
 }
 
 void thread::join()
 {
-	if (joinable())
+	// Taking the record first makes the object non-joinable right away and a
+	// second join() or detach() a no-op
+	thread_start_info *ti = _thread_info.exchange(0, memory_order_acq_rel);
+
+	if (ti)
 	{
 		pthread_join(_thread_handle, NULL);
+		ti->release();
 	}
 }
 
 bool thread::joinable() const
 {
-	_data_mutex.lock();
-	bool result = !_not_a_thread;
-	_data_mutex.unlock();
+	thread_start_info *ti = _thread_info.load(memory_order_acquire);
 
-	return result;
+	return ti && !ti->finished.load(memory_order_acquire);
 }
 
 void thread::detach()
 {
-	_data_mutex.lock();
+	thread_start_info *ti = _thread_info.exchange(0, memory_order_acq_rel);
 
-	if (!_not_a_thread)
+	if (ti)
 	{
 		pthread_detach(_thread_handle);
-		_not_a_thread = true;
+		ti->release();
 	}
-
-	_data_mutex.unlock();
 }
 
 thread::id thread::get_id() const
@@ -140,7 +299,7 @@ thread::id thread::get_id() const
 	if (!joinable())
 		return id();
 
-	return _pthread_t_to_ID(_thread_handle);
+	return id(_id);
 }
 
 unsigned thread::hardware_concurrency()
@@ -167,25 +326,91 @@ void thread::swap(thread & other)
 
 	using std::swap;
 
-	lock_guard<mutex> lk1(_data_mutex);
-	lock_guard<mutex> lk2(other._data_mutex);
-
-	swap(_not_a_thread, other._not_a_thread);
-	swap(_thread_info, other._thread_info);
-
-	if (!_not_a_thread)
-		_thread_info->thread_object = this;
-
-	if (!other._not_a_thread)
-		other._thread_info->thread_object = &other;
+	// Like the rest of swap, not meant to race with other calls on either
+	// object
+	_thread_info.store(other._thread_info.exchange(_thread_info.load(memory_order_relaxed), memory_order_acq_rel), memory_order_release);
 
 	// swap handles of threads
 	swap(_thread_handle, other._thread_handle);
+	swap(_id, other._id);
 }
 
 thread::id this_thread::get_id()
 {
-	return _pthread_t_to_ID(pthread_self());
+	unsigned long int result = _this_thread_id::get();
+
+	// Threads not started through stdex::thread (the main thread f.e.) get
+	// their id on first request
+	if (!result)
+	{
+		result = _new_thread_id();
+		_this_thread_id::set(result);
+	}
+
+	return thread::id(result);
+}
+
+void this_thread::set_affinity(const thread::cpu_mask &cpus)
+{
+#ifdef _STDEX_THREAD_AFFINITY
+	cpu_set_t cpu_set;
+	_to_cpu_set(cpus, cpu_set);
+
+	int e = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+	if (e)
+		throw system_error(errc(e));
+#else
+	(void) cpus;
+	throw system_error(not_supported);
+#endif
+}
+
+void this_thread::set_scheduling(int policy, int priority)
+{
+	sched_param param;
+	param.sched_priority = priority;
+
+	int e = pthread_setschedparam(pthread_self(), policy, &param);
+	if (e)
+		throw system_error(errc(e));
+}
+
+void this_thread::set_name(const char *name) NOEXCEPT_FUNCTION
+{
+	char buf[16];
+	std::size_t i = 0;
+
+	for (; name[i] && i < sizeof(buf) - 1; ++i)
+		buf[i] = name[i];
+	buf[i] = 0;
+
+	_set_this_thread_name(buf);
+}
+
+namespace
+{
+	// sleep_until for a clock that can't be slept on directly.
+	template<class _Clock>
+	void _sleep_until_by_sleep_for(const struct timespec *abstime)
+	{
+		chrono::time_point<_Clock, chrono::nanoseconds> t(
+			chrono::seconds(abstime->tv_sec) + chrono::nanoseconds(abstime->tv_nsec));
+
+		for (typename _Clock::time_point now = _Clock::now(); now < t; now = _Clock::now())
+			this_thread::sleep_for(t - now);
+	}
+}
+
+void this_thread::precise_sleep_until(const chrono::steady_clock::time_point &t, const precise_sleep_policy &policy)
+{
+	if (t - chrono::steady_clock::now() > policy.yield_margin)
+		sleep_until(t - policy.yield_margin);
+
+	while (chrono::steady_clock::now() < t - policy.spin_margin)
+		yield();
+
+	while (chrono::steady_clock::now() < t)
+		detail::cpu_relax();
 }
 
 #ifdef __PTW32_H // using windows implementation of POSIX threads
@@ -341,11 +566,64 @@ void detail::sleep_for_impl(const struct timespec *reltime)
 	timer.Start(us100);
 }
 
+void detail::sleep_until_steady_impl(const struct timespec *abstime)
+{
+	_sleep_until_by_sleep_for<chrono::steady_clock>(abstime);
+}
+
+void detail::sleep_until_system_impl(const struct timespec *abstime)
+{
+	_sleep_until_by_sleep_for<chrono::system_clock>(abstime);
+}
+
 #else
 void detail::sleep_for_impl(const struct timespec *reltime)
 {
-	nanosleep(reltime, NULL);
+	timespec req = *reltime, rem;
+
+	// continue after a signal handler
+	while (nanosleep(&req, &rem) == -1 && errno == EINTR)
+		req = rem;
+}
+
+#if defined(TIMER_ABSTIME) && !defined(__APPLE__)
+
+namespace
+{
+	void _clock_sleep_until(clockid_t clock, const struct timespec *abstime)
+	{
+		// returns the error instead of setting errno
+		while (clock_nanosleep(clock, TIMER_ABSTIME, abstime, NULL) == EINTR);
+	}
+}
+
+void detail::sleep_until_steady_impl(const struct timespec *abstime)
+{
+#ifdef CLOCK_MONOTONIC
+	_clock_sleep_until(CLOCK_MONOTONIC, abstime);
+#else
+	_clock_sleep_until(CLOCK_REALTIME, abstime);
+#endif
+}
+
+void detail::sleep_until_system_impl(const struct timespec *abstime)
+{
+	_clock_sleep_until(CLOCK_REALTIME, abstime);
 }
 
+#else // no clock_nanosleep
+
+void detail::sleep_until_steady_impl(const struct timespec *abstime)
+{
+	_sleep_until_by_sleep_for<chrono::steady_clock>(abstime);
+}
+
+void detail::sleep_until_system_impl(const struct timespec *abstime)
+{
+	_sleep_until_by_sleep_for<chrono::system_clock>(abstime);
+}
+
+#endif // TIMER_ABSTIME
+
 #endif
 
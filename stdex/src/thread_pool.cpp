@@ -0,0 +1,439 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/thread_pool"
+#include "../include/thread_specific_ptr"
+
+// POSIX includes
+/*none*/
+
+// std includes
+#include <exception>
+
+using namespace stdex;
+
+namespace
+{
+	// Index arithmetic that wraps around instead of overflowing.
+	inline long _index_add(long i, long n)
+	{
+		return static_cast<long>(static_cast<unsigned long>(i) + static_cast<unsigned long>(n));
+	}
+
+	inline long _index_distance(long from, long to)
+	{
+		return static_cast<long>(static_cast<unsigned long>(to) - static_cast<unsigned long>(from));
+	}
+
+	// Worker of the calling thread (points to thread_pool::worker), 0 if the
+	// calling thread is not a pool worker.
+	struct _current_worker_tag;
+	typedef thread_local_pod<void*, _current_worker_tag> _current_worker;
+}
+
+/// Chase-Lev work-stealing deque. The owning worker pushes and pops at the
+/// bottom without locking, other workers steal from the top with a single
+/// compare-and-swap. Arrays replaced on growth are kept until destruction
+/// because a thief may still read from them.
+class thread_pool::work_stealing_deque
+{
+public:
+	work_stealing_deque() :
+		_top(0),
+		_bottom(0),
+		_array(new array(64, 0)),
+		_retired(0)
+	{}
+
+	~work_stealing_deque()
+	{
+		delete _array.load(memory_order_relaxed);
+
+		while (_retired)
+		{
+			array *next = _retired->retired_next;
+			delete _retired;
+			_retired = next;
+		}
+	}
+
+	// Owner only.
+	void push(task *t)
+	{
+		long b = _bottom.load(memory_order_relaxed);
+		long top = _top.load(memory_order_acquire);
+		array *a = _array.load(memory_order_relaxed);
+
+		if (_index_distance(top, b) >= a->size - 1)
+			a = _grow(a, top, b);
+
+		a->put(b, t);
+
+		// publish the task before the new bottom
+		atomic_thread_fence(memory_order_release);
+		_bottom.store(_index_add(b, 1), memory_order_relaxed);
+	}
+
+	// Owner only.
+	task* pop()
+	{
+		long b = _index_add(_bottom.load(memory_order_relaxed), -1);
+		array *a = _array.load(memory_order_relaxed);
+
+		_bottom.store(b, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+
+		long t = _top.load(memory_order_relaxed);
+		long size = _index_distance(t, b);
+
+		if (size < 0)
+		{// empty
+			_bottom.store(t, memory_order_relaxed);
+			return 0;
+		}
+
+		task *result = a->get(b);
+
+		if (size > 0)
+			return result;
+
+		// the last task: race with the thieves for it
+		if (!_top.compare_exchange_strong(t, _index_add(t, 1), memory_order_seq_cst, memory_order_relaxed))
+			result = 0;
+
+		_bottom.store(_index_add(b, 1), memory_order_relaxed);
+
+		return result;
+	}
+
+	// Any thread. Returns 0 if the deque is empty or another thread won the race.
+	task* steal()
+	{
+		long t = _top.load(memory_order_acquire);
+		atomic_thread_fence(memory_order_seq_cst);
+		long b = _bottom.load(memory_order_acquire);
+
+		if (_index_distance(t, b) <= 0)
+			return 0;
+
+		task *result = _array.load(memory_order_acquire)->get(t);
+
+		if (!_top.compare_exchange_strong(t, _index_add(t, 1), memory_order_seq_cst, memory_order_relaxed))
+			return 0;
+
+		return result;
+	}
+
+	bool empty() const
+	{
+		return _index_distance(_top.load(memory_order_relaxed), _bottom.load(memory_order_relaxed)) <= 0;
+	}
+
+private:
+	struct array
+	{
+		long size; // power of 2
+		atomic<task*> *items;
+		array *retired_next;
+
+		array(long size_, array *retired_next_) :size(size_), items(new atomic<task*>[size_]), retired_next(retired_next_) {}
+		~array() { delete [] items; }
+
+		task* get(long i) const { return items[i & (size - 1)].load(memory_order_relaxed); }
+		void put(long i, task *t) { items[i & (size - 1)].store(t, memory_order_relaxed); }
+	};
+
+	atomic<long> _top;
+	atomic<long> _bottom;
+	atomic<array*> _array;
+	array *_retired;
+
+	array* _grow(array *a, long t, long b)
+	{
+		array *grown = new array(a->size * 2, 0);
+
+		for (long i = t; i != b; i = _index_add(i, 1))
+			grown->put(i, a->get(i));
+
+		a->retired_next = _retired;
+		_retired = a;
+
+		// publish the copied tasks with the array
+		_array.store(grown, memory_order_release);
+
+		return grown;
+	}
+
+	work_stealing_deque(const work_stealing_deque&) DELETED_FUNCTION;
+	work_stealing_deque& operator=(const work_stealing_deque&) DELETED_FUNCTION;
+};
+
+/// Worker thread state.
+struct thread_pool::worker
+{
+	thread_pool *pool;
+	work_stealing_deque tasks;
+	thread *thread_object;
+	unsigned long random_state; ///< Victim selection for stealing (xorshift).
+
+	worker() :pool(0), thread_object(0), random_state(0) {}
+
+	unsigned long next_random()
+	{
+		unsigned long x = random_state;
+		x ^= (x << 13) & 0xffffffffUL;
+		x ^= x >> 17;
+		x ^= (x << 5) & 0xffffffffUL;
+		return (random_state = x);
+	}
+};
+
+thread_pool::thread_pool(unsigned threads) :
+	_workers(0),
+	_worker_count(threads ? threads : thread::hardware_concurrency()),
+	_queue_head(0),
+	_queue_tail(0),
+	_queued(0),
+	_sleepers(0),
+	_stopping(false),
+	_pending(0)
+{
+	if (!_worker_count)
+		_worker_count = 1;
+
+	_workers = new worker[_worker_count];
+
+	for (unsigned i = 0; i < _worker_count; ++i)
+	{
+		_workers[i].pool = this;
+		_workers[i].random_state = 0x9e3779b9UL + i;
+	}
+
+	unsigned started = 0;
+
+	try
+	{
+		for (; started < _worker_count; ++started)
+			_workers[started].thread_object = new thread(&_worker_main, &_workers[started]);
+	}
+	catch (...)
+	{
+		// No destructor runs for a constructor that throws, and the workers
+		// started so far use this pool
+		_stop(started);
+		throw;
+	}
+}
+
+thread_pool::~thread_pool()
+{
+	_stop(_worker_count);
+}
+
+// Stop the first started workers, join them and free the workers.
+void thread_pool::_stop(unsigned started)
+{
+	{
+		lock_guard<mutex> guard(_sleep_lock);
+		_stopping = true;
+		_wake_up.notify_all();
+	}
+
+	for (unsigned i = 0; i < started; ++i)
+	{
+		_workers[i].thread_object->join();
+		delete _workers[i].thread_object;
+	}
+
+	delete [] _workers;
+}
+
+void thread_pool::wait()
+{
+	unique_lock<mutex> lock(_done_lock);
+
+	while (_pending.load(memory_order_acquire) != 0)
+		_done.wait(lock);
+}
+
+void thread_pool::_submit(task *t)
+{
+	_pending.fetch_add(1, memory_order_relaxed);
+
+	worker *w = static_cast<worker*>(_current_worker::get());
+
+	if (w && w->pool == this)
+		w->tasks.push(t);
+	else
+	{
+		lock_guard<mutex> guard(_queue_lock);
+
+		if (_queue_tail)
+			_queue_tail->next = t;
+		else
+			_queue_head = t;
+		_queue_tail = t;
+
+		_queued.fetch_add(1, memory_order_relaxed);
+	}
+
+	_wake_one();
+}
+
+void thread_pool::_wake_one()
+{
+	// pairs with the increment of _sleepers in _sleep(): either the sleeper
+	// sees the new task or we see the sleeper
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (_sleepers.load(memory_order_relaxed))
+	{
+		lock_guard<mutex> guard(_sleep_lock);
+		_wake_up.notify_one();
+	}
+}
+
+thread_pool::task* thread_pool::_dequeue_submitted()
+{
+	if (!_queued.load(memory_order_relaxed))
+		return 0;
+
+	lock_guard<mutex> guard(_queue_lock);
+
+	task *t = _queue_head;
+
+	if (t)
+	{
+		_queue_head = t->next;
+		if (!_queue_head)
+			_queue_tail = 0;
+
+		_queued.fetch_sub(1, memory_order_relaxed);
+	}
+
+	return t;
+}
+
+thread_pool::task* thread_pool::_find_task(worker &w)
+{
+	task *t = w.tasks.pop();
+
+	if (t)
+		return t;
+
+	t = _dequeue_submitted();
+
+	if (t)
+		return t;
+
+	// steal, starting at a random victim to spread the thieves
+	if (_worker_count > 1)
+	{
+		unsigned start = static_cast<unsigned>(w.next_random() % _worker_count);
+
+		for (unsigned round = 0; round < 2; ++round)
+		{
+			for (unsigned i = 0; i < _worker_count; ++i)
+			{
+				worker &victim = _workers[(start + i) % _worker_count];
+
+				if (&victim == &w)
+					continue;
+
+				t = victim.tasks.steal();
+
+				if (t)
+				{
+					// there may be more to steal, let another sleeper help
+					if (!victim.tasks.empty())
+						_wake_one();
+					return t;
+				}
+			}
+
+			detail::cpu_relax();
+		}
+	}
+
+	return 0;
+}
+
+bool thread_pool::_has_work() const
+{
+	if (_queued.load(memory_order_relaxed))
+		return true;
+
+	for (unsigned i = 0; i < _worker_count; ++i)
+		if (!_workers[i].tasks.empty())
+			return true;
+
+	return false;
+}
+
+bool thread_pool::_sleep()
+{
+	unique_lock<mutex> lock(_sleep_lock);
+
+	_sleepers.fetch_add(1, memory_order_relaxed);
+
+	// pairs with the fence in _wake_one()
+	atomic_thread_fence(memory_order_seq_cst);
+
+	bool keep_running = true;
+
+	while (!_has_work())
+	{
+		if (_stopping)
+		{
+			keep_running = false;
+			break;
+		}
+
+		_wake_up.wait(lock);
+	}
+
+	_sleepers.fetch_sub(1, memory_order_relaxed);
+
+	return keep_running;
+}
+
+void thread_pool::_run(task *t)
+{
+	try
+	{
+		t->run();
+	}
+	catch (...)
+	{
+		// Uncaught exceptions will terminate the application (same as for
+		// the thread function of stdex::thread)
+		std::terminate();
+	}
+
+	delete t;
+
+	if (_pending.fetch_sub(1, memory_order_acq_rel) == 1)
+	{
+		lock_guard<mutex> guard(_done_lock);
+		_done.notify_all();
+	}
+}
+
+void thread_pool::_worker_main(void *aArg)
+{
+	worker &w = *static_cast<worker*>(aArg);
+	thread_pool &pool = *w.pool;
+
+	_current_worker::set(&w);
+
+	forever
+	{
+		task *t = pool._find_task(w);
+
+		if (t)
+			pool._run(t);
+		else if (!pool._sleep())
+			break;
+	}
+
+	_current_worker::set(0);
+}
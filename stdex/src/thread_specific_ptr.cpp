@@ -0,0 +1,243 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/thread_specific_ptr"
+#include "../include/system_error"
+
+// POSIX includes
+/*none*/
+
+// std includes
+/*none*/
+
+using namespace stdex;
+
+namespace
+{
+	// Nodes of the calling thread, most recently attached first. A key
+	// rather than a thread_local_pod so nodes of deleted keys, whose key
+	// destructors no longer run, are freed at thread exit too.
+	pthread_key_t _tss_list_key;
+	atomic<int> _tss_list_once; // zero-initialized, see detail::_call_once
+
+	void _tss_list_exit(void *p);
+
+	void _tss_create_list_key()
+	{
+		pthread_key_create(&_tss_list_key, &_tss_list_exit);
+	}
+
+	pthread_key_t _tss_list()
+	{
+		detail::_call_once(_tss_list_once, &_tss_create_list_key);
+		return _tss_list_key;
+	}
+
+	detail::_tss_node* _tss_head()
+	{
+		return static_cast<detail::_tss_node*>(pthread_getspecific(_tss_list()));
+	}
+
+	void _tss_set_head(detail::_tss_node *node)
+	{
+		pthread_setspecific(_tss_list(), node);
+	}
+
+	void _tss_release_key(detail::_tss_key *key)
+	{
+		if (key->refs.fetch_sub(1, memory_order_acq_rel) == 1)
+			delete key;
+	}
+
+	void _tss_free(detail::_tss_node *node)
+	{
+		_tss_release_key(node->owner);
+		delete node;
+	}
+
+	bool _tss_orphaned(const detail::_tss_node *node)
+	{
+		return node->owner->deleted.load(memory_order_acquire);
+	}
+
+	void _tss_unlink(detail::_tss_node *node)
+	{
+		detail::_tss_node *head = _tss_head();
+
+		if (head == node)
+		{
+			_tss_set_head(node->next);
+			return;
+		}
+
+		for (detail::_tss_node *it = head; it; it = it->next)
+		{
+			if (it->next == node)
+			{
+				it->next = node->next;
+				return;
+			}
+		}
+	}
+
+	// Free the nodes of the calling thread whose keys have been deleted.
+	void _tss_sweep()
+	{
+		detail::_tss_node **link = 0;
+		detail::_tss_node *head = _tss_head();
+		detail::_tss_node *node = head;
+
+		while (node)
+		{
+			detail::_tss_node *next = node->next;
+
+			if (_tss_orphaned(node))
+			{
+				if (link)
+					*link = next;
+				else
+					head = next;
+
+				_tss_free(node);
+			}
+			else
+				link = &node->next;
+
+			node = next;
+		}
+
+		_tss_set_head(head);
+	}
+
+	// List destructor, runs at exit of any thread with nodes. The nodes of
+	// live keys are left to their key destructors.
+	void _tss_list_exit(void *p)
+	{
+		detail::_tss_node *node = static_cast<detail::_tss_node*>(p);
+
+		while (node)
+		{
+			detail::_tss_node *next = node->next;
+
+			if (_tss_orphaned(node))
+				_tss_free(node);
+
+			node = next;
+		}
+	}
+
+	// Key destructor, runs at exit of any thread with a node for the key.
+	void _tss_node_exit(void *p)
+	{
+		detail::_tss_node *node = static_cast<detail::_tss_node*>(p);
+
+		if (node->value && node->cleanup)
+		{
+			void *value = node->value;
+			node->value = 0;
+			node->invoke(node->cleanup, value);
+		}
+
+		_tss_unlink(node);
+		_tss_free(node);
+	}
+}
+
+detail::_tss_key* detail::_tss_create_key()
+{
+	_tss_key *key = new _tss_key;
+
+	int e = pthread_key_create(&key->key, &_tss_node_exit);
+	if (e)
+	{
+		delete key;
+		throw system_error(errc(e));
+	}
+
+	key->refs.store(1, memory_order_relaxed);
+	key->deleted.store(false, memory_order_relaxed);
+
+	return key;
+}
+
+void detail::_tss_delete_key(_tss_key *key)
+{
+	key->deleted.store(true, memory_order_release);
+	pthread_key_delete(key->key);
+	_tss_release_key(key);
+}
+
+detail::_tss_node* detail::_tss_attach(_tss_key *key, void(*cleanup)(), void(*invoke)(void(*)(), void*))
+{
+	// Long-lived threads drop what deleted keys left behind here
+	_tss_sweep();
+
+	_tss_node *node = new _tss_node;
+
+	node->value = 0;
+	node->cleanup = cleanup;
+	node->invoke = invoke;
+	node->owner = key;
+	node->round = 0;
+	node->next = _tss_head();
+
+	int e = pthread_setspecific(key->key, node);
+	if (e)
+	{
+		delete node;
+		throw system_error(errc(e));
+	}
+
+	key->refs.fetch_add(1, memory_order_relaxed);
+	_tss_set_head(node);
+
+	return node;
+}
+
+void detail::_tss_detach(_tss_key *key)
+{
+	_tss_node *node = static_cast<_tss_node*>(pthread_getspecific(key->key));
+
+	if (node)
+	{
+		pthread_setspecific(key->key, 0);
+		_tss_unlink(node);
+		_tss_free(node);
+	}
+}
+
+void detail::_tss_run_cleanups()
+{
+	_tss_sweep();
+
+	for (_tss_node *node = _tss_head(); node; node = node->next)
+		node->round = 0;
+
+	// A cleanup may set values again; give up after a few rounds like
+	// PTHREAD_DESTRUCTOR_ITERATIONS does. It may also free nodes (destroying
+	// a thread_specific_ptr), so the walk starts over after each cleanup and
+	// skips the nodes done in this round.
+	for (unsigned round = 1; round <= 4; ++round)
+	{
+		bool ran = false;
+		_tss_node *node = _tss_head();
+
+		while (node)
+		{
+			if (node->value && node->cleanup && node->round != round && !_tss_orphaned(node))
+			{
+				void *value = node->value;
+				node->value = 0;
+				node->round = round;
+				node->invoke(node->cleanup, value);
+				ran = true;
+
+				node = _tss_head();
+			}
+			else
+				node = node->next;
+		}
+
+		if (!ran)
+			break;
+	}
+}
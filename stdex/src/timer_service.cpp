@@ -0,0 +1,427 @@
+// stdex includes
+#include "../include/core.h"
+#include "../include/timer_service"
+
+// POSIX includes
+/*none*/
+
+// std includes
+/*none*/
+
+using namespace stdex;
+
+struct timer_service::timer
+{
+	timer *next;
+	timer *prev;
+	uintmax_t expires;           // tick
+	callback_type func;
+	void *arg;
+	unsigned long generation;
+	unsigned slot;               // _slots while not in the wheel
+};
+
+namespace
+{
+	const unsigned _block_size = 256;        // timers allocated at once
+	const uintmax_t _max_delta = 0xffffffffUL; // farther timers are cascaded again
+
+	// Index of the lowest set bit of a non-zero word.
+	inline unsigned _lowest_bit(uintmax_t word)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+		unsigned i = 0;
+
+		while (!(word & 1))
+		{
+			word >>= 1;
+			++i;
+		}
+
+		return i;
+#endif
+	}
+
+	inline uintmax_t _rotate_right(uintmax_t word, unsigned n)
+	{
+		return n ? (word >> n) | (word << (64 - n)) : word;
+	}
+
+	// Shift of the tick bits that index a slot of the wheel level (1..4).
+	inline unsigned _level_shift(unsigned level)
+	{
+		return 8 + 6 * (level - 1);
+	}
+}
+
+timer_service::timer_service(const options &opts) :
+	_opts(opts),
+	_origin_us(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count()),
+	_tick_us(opts.resolution.count() > 0 ? opts.resolution.count() : 1),
+	_now(0),
+	_wake_tick(0),
+	_pending(0),
+	_free(0),
+	_stopping(false)
+{
+	for (unsigned i = 0; i < _slots; ++i)
+		_wheel[i] = 0;
+
+	for (unsigned i = 0; i < _bitmap_words; ++i)
+		_occupied[i] = 0;
+
+	thread::attributes attr;
+	thread service(attr.name("timer_service"), &_thread_main, this);
+
+	_thread.swap(service);
+}
+
+timer_service::~timer_service()
+{
+	{
+		unique_lock<mutex> lock(_lock);
+		_stopping = true;
+	}
+
+	_wake_up.notify_one();
+	_thread.join();
+
+	for (std::size_t i = 0; i < _blocks.size(); ++i)
+		delete [] _blocks[i];
+}
+
+timer_service::timer_id timer_service::_schedule(intmax_t deadline_us, callback_type func, void *arg)
+{
+	unique_lock<mutex> lock(_lock);
+
+	timer *t = _allocate();
+
+	t->expires = _tick_at(deadline_us + _tick_us - 1); // rounded up
+	t->func = func;
+	t->arg = arg;
+
+	_insert(t);
+	++_pending;
+
+	timer_id id(t, t->generation);
+
+	// Wake the service thread if it sleeps past the new deadline
+	if (t->expires < _wake_tick)
+	{
+		_wake_tick = 0;
+		lock.unlock();
+		_wake_up.notify_one();
+	}
+
+	return id;
+}
+
+bool timer_service::cancel(timer_id id)
+{
+	timer *t = id._timer;
+
+	if (!t)
+		return false;
+
+	lock_guard<mutex> lock(_lock);
+
+	// A fired timer is out of the wheel until it is released, and gets a
+	// new generation then
+	if (t->generation != id._generation || t->slot == _slots)
+		return false;
+
+	_unlink(t);
+	--_pending;
+	_release(t);
+
+	return true;
+}
+
+std::size_t timer_service::pending() const
+{
+	lock_guard<mutex> lock(_lock);
+
+	return _pending;
+}
+
+timer_service::timer* timer_service::_allocate()
+{
+	if (!_free)
+	{
+		timer *block = new timer[_block_size];
+
+		_blocks.push_back(block);
+
+		for (unsigned i = 0; i < _block_size; ++i)
+		{
+			block[i].generation = 0;
+			block[i].slot = _slots;
+			block[i].next = (i + 1 < _block_size) ? &block[i + 1] : 0;
+		}
+
+		_free = block;
+	}
+
+	timer *t = _free;
+	_free = t->next;
+
+	return t;
+}
+
+void timer_service::_release(timer *t)
+{
+	++t->generation;
+	t->slot = _slots;
+	t->next = _free;
+	_free = t;
+}
+
+void timer_service::_insert(timer *t)
+{
+	// Timers already due go to the slot processed next
+	uintmax_t expires = (t->expires < _now) ? _now : t->expires;
+	uintmax_t delta = expires - _now;
+	unsigned slot;
+
+	if (delta < _root_size)
+		slot = static_cast<unsigned>(expires & (_root_size - 1));
+	else
+	{
+		if (delta > _max_delta)
+			expires = _now + _max_delta;
+
+		unsigned level = 1;
+
+		while (level < _levels - 1 && (expires - _now) >> (_level_shift(level) + _level_bits))
+			++level;
+
+		slot = _root_size + (level - 1) * _level_size
+			+ static_cast<unsigned>((expires >> _level_shift(level)) & (_level_size - 1));
+	}
+
+	timer *head = _wheel[slot];
+
+	t->slot = slot;
+	t->prev = 0;
+	t->next = head;
+
+	if (head)
+		head->prev = t;
+
+	_wheel[slot] = t;
+	_occupied[slot / 64] |= uintmax_t(1) << (slot % 64);
+}
+
+void timer_service::_unlink(timer *t)
+{
+	if (t->prev)
+		t->prev->next = t->next;
+	else
+		_wheel[t->slot] = t->next;
+
+	if (t->next)
+		t->next->prev = t->prev;
+
+	if (!_wheel[t->slot])
+		_occupied[t->slot / 64] &= ~(uintmax_t(1) << (t->slot % 64));
+}
+
+// Move the timers of the slot of level due at _now one level (or more) down.
+void timer_service::_cascade(unsigned level)
+{
+	unsigned slot = _root_size + (level - 1) * _level_size
+		+ static_cast<unsigned>((_now >> _level_shift(level)) & (_level_size - 1));
+
+	timer *t = _wheel[slot];
+
+	_wheel[slot] = 0;
+	_occupied[slot / 64] &= ~(uintmax_t(1) << (slot % 64));
+
+	while (t)
+	{
+		timer *next = t->next;
+		_insert(t);
+		t = next;
+	}
+}
+
+// Process the ticks up to and including tick; returns the timers that are
+// due, out of the wheel and linked by next.
+timer_service::timer* timer_service::_advance(uintmax_t tick)
+{
+	timer *due = 0;
+	timer **due_tail = &due;
+
+	while (_now <= tick)
+	{
+		unsigned index = static_cast<unsigned>(_now & (_root_size - 1));
+
+		if (index == 0)
+		{
+			for (unsigned level = 1; level < _levels; ++level)
+			{
+				_cascade(level);
+
+				if ((_now >> _level_shift(level)) & (_level_size - 1))
+					break;
+			}
+		}
+
+		if (_wheel[index])
+		{
+			timer *t = _wheel[index];
+
+			_wheel[index] = 0;
+			_occupied[index / 64] &= ~(uintmax_t(1) << (index % 64));
+
+			*due_tail = t;
+
+			for (; t; t = t->next)
+			{
+				t->slot = _slots;
+				--_pending;
+				due_tail = &t->next;
+			}
+		}
+
+		// Skip the empty slots up to the next occupied one or the end of the
+		// first wheel, where the next cascade is, but not past tick: timers
+		// scheduled later must not land behind _now
+		uintmax_t next = (_now | (_root_size - 1)) + 1;
+
+		for (unsigned word = (index + 1) / 64; word < _root_size / 64; ++word)
+		{
+			uintmax_t bits = _occupied[word];
+
+			if (word == (index + 1) / 64)
+				bits &= ~uintmax_t(0) << ((index + 1) % 64);
+
+			if (bits)
+			{
+				next = (_now & ~uintmax_t(_root_size - 1)) + word * 64 + _lowest_bit(bits);
+				break;
+			}
+		}
+
+		_now = (next <= tick) ? next : tick + 1;
+	}
+
+	return due;
+}
+
+// First tick at which _advance() has work: a timer of the first wheel is
+// due, or a non-empty slot of another wheel is cascaded. ~0 if there are no
+// timers.
+uintmax_t timer_service::_next_event() const
+{
+	uintmax_t result = ~uintmax_t(0);
+	unsigned index = static_cast<unsigned>(_now & (_root_size - 1));
+	uintmax_t base = _now & ~uintmax_t(_root_size - 1);
+
+	for (unsigned i = 0; i <= _root_size / 64; ++i)
+	{
+		// Slots from the current one on, then the ones before it, which hold
+		// the timers of the next turn of the wheel
+		unsigned word = (index / 64 + i) % (_root_size / 64);
+		bool next_turn = (i == _root_size / 64 || word < index / 64);
+		uintmax_t bits = _occupied[word];
+
+		if (i == 0)
+			bits &= ~uintmax_t(0) << (index % 64);
+		else if (i == _root_size / 64)
+			bits &= ~(~uintmax_t(0) << (index % 64));
+
+		if (bits)
+		{
+			result = base + word * 64 + _lowest_bit(bits) + (next_turn ? _root_size : 0);
+			break;
+		}
+	}
+
+	for (unsigned level = 1; level < _levels; ++level)
+	{
+		uintmax_t bits = _occupied[_root_size / 64 + level - 1];
+
+		if (!bits)
+			continue;
+
+		// Slot k steps ahead of the current one is cascaded at the k-th
+		// multiple of the level width from _now on (k = 0 if _now is one)
+		unsigned shift = _level_shift(level);
+		uintmax_t first = (_now & ((uintmax_t(1) << shift) - 1)) ? 1 : 0;
+		unsigned start = static_cast<unsigned>(((_now >> shift) + first) & (_level_size - 1));
+		uintmax_t k = first + _lowest_bit(_rotate_right(bits, start));
+		uintmax_t tick = ((_now >> shift) + k) << shift;
+
+		if (tick < result)
+			result = tick;
+	}
+
+	return result;
+}
+
+uintmax_t timer_service::_tick_at(intmax_t time_us) const
+{
+	return (time_us > _origin_us) ? static_cast<uintmax_t>(time_us - _origin_us) / _tick_us : 0;
+}
+
+intmax_t timer_service::_time_of(uintmax_t tick) const
+{
+	return _origin_us + static_cast<intmax_t>(tick) * _tick_us;
+}
+
+void timer_service::_run()
+{
+	unique_lock<mutex> lock(_lock);
+
+	while (!_stopping)
+	{
+		intmax_t now = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+		timer *due = _advance(_tick_at(now));
+
+		if (due)
+		{
+			_wake_tick = 0; // looks again before sleeping
+
+			lock.unlock();
+
+			for (timer *t = due; t; t = t->next)
+			{
+				if (_opts.dispatch)
+					_opts.dispatch(t->func, t->arg, _opts.dispatch_context);
+				else
+					t->func(t->arg);
+			}
+
+			lock.lock();
+
+			while (due)
+			{
+				timer *next = due->next;
+				_release(due);
+				due = next;
+			}
+
+			continue;
+		}
+
+		_wake_tick = _next_event();
+
+		if (_wake_tick == ~uintmax_t(0))
+			_wake_up.wait(lock);
+		else
+		{
+			chrono::steady_clock::time_point wake_time(
+				chrono::microseconds(_time_of(_wake_tick) + _opts.slack.count()));
+
+			_wake_up.wait_until(lock, wake_time);
+		}
+	}
+}
+
+void timer_service::_thread_main(void *aArg)
+{
+	static_cast<timer_service*>(aArg)->_run();
+}